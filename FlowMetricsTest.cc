@@ -0,0 +1,169 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//Checks the FlowMonitor post-processing of flow-metrics.h against values
+//worked out by hand. Prints every mismatch and exits with 1 if there is
+//any, so it can gate a change to the metrics.
+
+//Import libraries
+#include "ns3/core-module.h"
+#include "ns3/flow-monitor-module.h"
+
+#include "flow-metrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+//Define namespace
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("FlowMetricsTest");
+
+static uint32_t g_checks = 0;
+static uint32_t g_failures = 0;
+
+static void
+Check (std::string what, double got, double expected)
+{
+  g_checks++;
+  if (std::fabs (got - expected) > 1e-9 * std::max (1.0, std::fabs (expected)))
+    {
+      g_failures++;
+      std::cout << "FAIL " << what << ": got " << got << ", expected " << expected << "\n";
+    }
+}
+
+//A flow with every counter set, the remaining fields as given
+static FlowMonitor::FlowStats
+MakeFlowStats (double firstTxS, double lastRxS, uint64_t rxBytes, uint32_t txPackets, uint32_t rxPackets,
+               uint32_t lostPackets, double delaySumS, double jitterSumS)
+{
+  FlowMonitor::FlowStats st;
+  st.timeFirstTxPacket = Seconds (firstTxS);
+  st.timeFirstRxPacket = Seconds (firstTxS);
+  st.timeLastTxPacket = Seconds (lastRxS);
+  st.timeLastRxPacket = Seconds (lastRxS);
+  st.delaySum = Seconds (delaySumS);
+  st.jitterSum = Seconds (jitterSumS);
+  st.lastDelay = Seconds (0);
+  st.txBytes = rxBytes;
+  st.rxBytes = rxBytes;
+  st.txPackets = txPackets;
+  st.rxPackets = rxPackets;
+  st.lostPackets = lostPackets;
+  st.timesForwarded = 0;
+  st.delayHistogram.SetDefaultBinWidth (1e-3);
+  st.jitterHistogram.SetDefaultBinWidth (1e-3);
+  st.packetSizeHistogram.SetDefaultBinWidth (20);
+  return st;
+}
+
+//Main function
+int main (int argc, char *argv[])
+{
+  CommandLine cmd;
+  cmd.Parse (argc, argv);
+
+  //1.25 MB in 2 s is 10 Mbit in 2 s
+  Check ("GoodputMbps 1.25MB/2s", GoodputMbps (1250000, 2.0), 5.0);
+  Check ("GoodputMbps zero window", GoodputMbps (1250000, 0.0), 0.0);
+  Check ("GoodputMbps negative window", GoodputMbps (1250000, -1.0), 0.0);
+
+  Check ("SafeRatio 3/4", SafeRatio (3, 4), 0.75);
+  Check ("SafeRatio x/0", SafeRatio (3, 0), 0.0);
+
+  //(sum x)^2 / (n sum x^2)
+  std::vector<double> equal (4, 2.0);
+  Check ("JainIndex equal", JainIndex (equal), 1.0);
+  std::vector<double> one (4, 0.0);
+  one[0] = 4.0;
+  Check ("JainIndex one gets all", JainIndex (one), 0.25);
+  std::vector<double> ramp;
+  ramp.push_back (1.0);
+  ramp.push_back (2.0);
+  ramp.push_back (3.0);
+  Check ("JainIndex 1,2,3", JainIndex (ramp), 36.0 / 42.0);
+  Check ("JainIndex empty", JainIndex (std::vector<double> ()), 0.0);
+  Check ("JainIndex all zero", JainIndex (std::vector<double> (3, 0.0)), 0.0);
+
+  //bins of 1: two samples in [0,1), none in [1,2), two in [2,3)
+  Histogram hist (1.0);
+  hist.AddValue (0.5);
+  hist.AddValue (0.5);
+  hist.AddValue (2.5);
+  hist.AddValue (2.5);
+  Check ("HistogramPercentile p25", HistogramPercentile (hist, 0.25), 0.5);
+  Check ("HistogramPercentile p50", HistogramPercentile (hist, 0.50), 1.0);
+  Check ("HistogramPercentile p75", HistogramPercentile (hist, 0.75), 2.5);
+  Check ("HistogramPercentile p100", HistogramPercentile (hist, 1.0), 3.0);
+  Check ("HistogramPercentile empty", HistogramPercentile (Histogram (1.0), 0.5), 0.0);
+
+  //1000 packets of 1250 bytes from 1 s to 3 s, 10 ms each, 1 ms jitter
+  FlowMetrics m = ComputeFlowMetrics (MakeFlowStats (1.0, 3.0, 1250000, 1050, 1000, 50, 10.0, 0.999));
+  Check ("flow degenerate", m.degenerate, 0);
+  Check ("flow durationS", m.durationS, 2.0);
+  Check ("flow goodputMbps", m.goodputMbps, 5.0);
+  Check ("flow meanDelayMs", m.meanDelayMs, 10.0);
+  Check ("flow meanJitterMs", m.meanJitterMs, 1.0);
+  Check ("flow lossRatio", m.lossRatio, 50.0 / 1050.0);
+
+  //a single packet has no goodput or jitter
+  m = ComputeFlowMetrics (MakeFlowStats (1.0, 1.5, 1250, 1, 1, 0, 0.5, 0.0));
+  Check ("single packet degenerate", m.degenerate, 1);
+  Check ("single packet goodputMbps", m.goodputMbps, 0.0);
+  Check ("single packet meanJitterMs", m.meanJitterMs, 0.0);
+  Check ("single packet meanDelayMs", m.meanDelayMs, 500.0);
+
+  //packets received in the instant the first was sent
+  m = ComputeFlowMetrics (MakeFlowStats (2.0, 2.0, 12500, 10, 10, 0, 0.0, 0.0));
+  Check ("zero duration degenerate", m.degenerate, 1);
+  Check ("zero duration goodputMbps", m.goodputMbps, 0.0);
+
+  //nothing sent or received
+  m = ComputeFlowMetrics (MakeFlowStats (0.0, 0.0, 0, 0, 0, 0, 0.0, 0.0));
+  Check ("empty flow degenerate", m.degenerate, 1);
+  Check ("empty flow meanDelayMs", m.meanDelayMs, 0.0);
+  Check ("empty flow lossRatio", m.lossRatio, 0.0);
+  Check ("empty flow p95DelayMs", m.p95DelayMs, 0.0);
+
+  //a TCP connection and its ACKs, then a flow to another port
+  FlowTuple data;
+  data.ipv6 = false;
+  data.source4 = Ipv4Address ("1.0.0.2");
+  data.destination4 = Ipv4Address ("7.0.0.2");
+  data.protocol = 6;
+  data.sourcePort = 49153;
+  data.destinationPort = 1234;
+  FlowTuple acks = data;
+  acks.source4 = data.destination4;
+  acks.destination4 = data.source4;
+  acks.sourcePort = data.destinationPort;
+  acks.destinationPort = data.sourcePort;
+  Check ("IsReverseFlow acks", IsReverseFlow (data, acks), 1);
+  Check ("IsReverseFlow symmetric", IsReverseFlow (acks, data), 1);
+  Check ("IsReverseFlow itself", IsReverseFlow (data, data), 0);
+  FlowTuple other = acks;
+  other.destinationPort = 1235;
+  Check ("IsReverseFlow other port", IsReverseFlow (data, other), 0);
+  other = acks;
+  other.protocol = 17;
+  Check ("IsReverseFlow other protocol", IsReverseFlow (data, other), 0);
+
+  std::cout << g_checks - g_failures << " of " << g_checks << " flow metrics checks passed\n";
+  return g_failures > 0 ? 1 : 0;
+}
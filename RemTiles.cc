@@ -0,0 +1,207 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//Downlink SINR coverage map of the walk area around the eNB or of the
+//train corridor, for LTE or mmWave, with the eNBs, loss models and
+//buildings of those scenarios. The map is computed in tiles by worker
+//processes (rem-tiles.h) and written as REM<scenario>.rem, .csv and .pgm.
+
+//Import libraries
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/lte-module.h"
+#include <ns3/buildings-helper.h>
+#include "ns3/mmwave-helper.h"
+#include "ns3/system-wall-clock-ms.h"
+
+#include "building-grid.h"
+#include "mmwave-numerology.h"
+#include "rail-corridor.h"
+#include "rem-tiles.h"
+
+#include <unistd.h>
+
+//Define namespace
+using namespace ns3;
+using namespace mmwave;
+
+NS_LOG_COMPONENT_DEFINE ("RemTiles");
+
+//Main function
+int main (int argc, char *argv[])
+{
+  //Defaults if none given at runtime
+  std::string tech = "lte"; //lte or mmwave
+  std::string area = "walk"; //walk (the RandomWalk box) or train (the UDPTrainJourney corridor)
+  double resolution = 0; //between points [m], 0 picks 1m for walk and 10m for train
+  double z = 0; //height of the UEs in the scenarios [m]
+  uint32_t tileSize = 64; //points per tile side
+  uint32_t workers = 0; //worker processes, 0 for one per CPU
+  uint16_t numberOfeNbs = 4; //train sites
+  double distance = 6000; //between train sites [m]
+  uint16_t sectorsPerSite = 1; //LTE train sites only
+  double siteOffset = 50; //of the train sites from the track [m]
+  double corridorWidth = 1000; //mapped across the track [m]
+  double bfGain = 30; //mmWave beamforming gain, 8x8 eNB and 4x4 UE arrays [dB]
+  MmWaveNumerology numerology = DefaultMmWaveNumerology ();
+  BuildingGrid grid = DefaultBuildingGrid (); //open space unless buildingBlocks is set
+  double minDb = -10; //black in the PGM
+  double maxDb = 30; //white in the PGM
+  double coverageSinr = 0; //SINR counted as covered [dB]
+
+  //Command line arguments, overrides defaults if given
+  CommandLine cmd;
+  cmd.AddValue ("tech", "Radio access: lte or mmwave", tech);
+  cmd.AddValue ("area", "Area mapped: walk (100m box around the eNB) or train (rail corridor)", area);
+  cmd.AddValue ("resolution", "Distance between points [m], 0 for 1m (walk) or 10m (train)", resolution);
+  cmd.AddValue ("z", "Height of the points [m]", z);
+  cmd.AddValue ("tileSize", "Points per side of a tile", tileSize);
+  cmd.AddValue ("workers", "Worker processes, 0 for one per CPU", workers);
+  cmd.AddValue ("numberOfeNbs", "Number of eNb sites on the train corridor", numberOfeNbs);
+  cmd.AddValue ("distance", "Distance between eNB sites along the track [m]", distance);
+  cmd.AddValue ("sectorsPerSite", "Sectors per LTE train site (1, 2 or 3)", sectorsPerSite);
+  cmd.AddValue ("siteOffset", "Distance of the sites from the track [m]", siteOffset);
+  cmd.AddValue ("corridorWidth", "Width of the corridor mapped across the track [m]", corridorWidth);
+  cmd.AddValue ("bfGain", "mmWave beamforming gain of the link [dB]", bfGain);
+  cmd.AddValue ("centreFreq", "mmWave carrier centre frequency [Hz]", numerology.centreFreqHz);
+  cmd.AddValue ("chunkPerRb", "mmWave chunks per resource block", numerology.chunkPerRb);
+  cmd.AddValue ("chunkWidth", "mmWave width of a chunk of 48 subcarriers [Hz]", numerology.chunkWidthHz);
+  cmd.AddValue ("buildingBlocks", "Blocks per side of the urban grid around the eNB, 0 for open space", grid.blocks);
+  cmd.AddValue ("blockSize", "Side of a building block [m]", grid.blockSize);
+  cmd.AddValue ("streetWidth", "Width of the streets between the blocks [m]", grid.streetWidth);
+  cmd.AddValue ("floors", "Floors of every building", grid.floors);
+  cmd.AddValue ("wallLoss", "Loss of the external walls of the buildings [dB]", grid.wallLossDb);
+  cmd.AddValue ("minDb", "SINR drawn black in the PGM [dB]", minDb);
+  cmd.AddValue ("maxDb", "SINR drawn white in the PGM [dB]", maxDb);
+  cmd.AddValue ("coverageSinr", "SINR a point needs to count as covered [dB]", coverageSinr);
+  cmd.Parse (argc, argv);
+
+  LogComponentEnable ("RemTiles", LOG_INFO);
+
+  NS_ABORT_MSG_IF (tech != "lte" && tech != "mmwave", "Unknown tech " << tech << ", use lte or mmwave");
+  NS_ABORT_MSG_IF (area != "walk" && area != "train", "Unknown area " << area << ", use walk or train");
+  bool train = area == "train";
+  if (resolution <= 0)
+    {
+      resolution = train ? 10.0 : 1.0;
+    }
+  if (workers == 0)
+    {
+      workers = std::max<long> (1, sysconf (_SC_NPROCESSORS_ONLN));
+    }
+  std::string name = (tech == "mmwave" ? "mmwave" : "") + std::string (train ? "TrainJourney" : "RandomWalk");
+
+  //The walk box of the RandomWalk scenarios, or the straight track of
+  //UDPTrainJourney with a site every distance metres
+  std::vector<Vector> trackPoints;
+  trackPoints.push_back (Vector (0.0, 0.0, 0.0));
+  trackPoints.push_back (Vector ((numberOfeNbs + 1) * distance, 0.0, 0.0));
+  RailCorridor corridor (trackPoints);
+  RemTiles rem (train ? 0.0 : -50.0, train ? corridor.GetLength () : 50.0,
+                train ? -corridorWidth / 2 : -50.0, train ? corridorWidth / 2 : 50.0, resolution, z);
+
+  CreateBuildingGrid (grid);
+  NodeContainer enbNodes;
+  NodeContainer probe;
+  probe.Create (1);
+  MobilityHelper mobility;
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (probe);
+  BuildingsHelper::Install (probe);
+
+  if (tech == "lte")
+    {
+      Ptr<LteHelper> lteHelper = CreateObject<LteHelper> ();
+      NetDeviceContainer enbDevs;
+      if (train)
+        {
+          enbNodes.Create (numberOfeNbs * sectorsPerSite);
+          enbDevs = corridor.InstallSites (lteHelper, enbNodes, sectorsPerSite, distance, distance, siteOffset, 30.0);
+        }
+      else
+        {
+          enbNodes.Create (1);
+          mobility.Install (enbNodes);
+          enbDevs = lteHelper->InstallEnbDevice (enbNodes);
+        }
+      BuildingsHelper::Install (enbNodes);
+
+      //Friis at the downlink carrier, the LteHelper default pathloss
+      Ptr<LteEnbNetDevice> enb = enbDevs.Get (0)->GetObject<LteEnbNetDevice> ();
+      Ptr<FriisPropagationLossModel> friis = CreateObject<FriisPropagationLossModel> ();
+      friis->SetFrequency (LteSpectrumValueHelper::GetDownlinkCarrierFrequency (enb->GetDlEarfcn ()));
+      if (grid.blocks > 0)
+        {
+          friis->SetNext (CreateBuildingPenetrationLoss (grid));
+        }
+      rem.SetLoss (friis, probe.Get (0)->GetObject<MobilityModel> ());
+      rem.SetNoiseDbm (NoiseDbm (enb->GetDlBandwidth () * 180e3, DoubleDefault ("ns3::LteUePhy", "NoiseFigure")));
+      for (uint32_t e = 0; e < enbDevs.GetN (); ++e)
+        {
+          Ptr<LteEnbPhy> phy = enbDevs.Get (e)->GetObject<LteEnbNetDevice> ()->GetPhy ();
+          rem.AddTransmitter (enbNodes.Get (e)->GetObject<MobilityModel> (),
+                              phy->GetDownlinkSpectrumPhy ()->GetRxAntenna (), phy->GetTxPower ());
+        }
+    }
+  else
+    {
+      ConfigureMmWaveNumerology (numerology);
+      Ptr<MmWaveHelper> ptr_mmWave = CreateObject<MmWaveHelper> ();
+      ptr_mmWave->Initialize ();
+      InstallBuildingLoss (ptr_mmWave, 1, grid);
+      //single sector sites at the LTE positions
+      enbNodes.Create (train ? numberOfeNbs : 1);
+      Ptr<ListPositionAllocator> positions = CreateObject<ListPositionAllocator> ();
+      for (uint32_t e = 0; e < enbNodes.GetN (); ++e)
+        {
+          positions->Add (train ? Vector (distance * (e + 1), siteOffset, 30.0) : Vector (0.0, 0.0, 0.0));
+        }
+      mobility.SetPositionAllocator (positions);
+      mobility.Install (enbNodes);
+      BuildingsHelper::Install (enbNodes);
+      ptr_mmWave->InstallEnbDevice (enbNodes);
+      //the mmWave pathloss models tell the UE end of a link by its device
+      ptr_mmWave->InstallUeDevice (probe);
+
+      rem.SetLoss (ptr_mmWave->GetPathLossModel (0), probe.Get (0)->GetObject<MobilityModel> ());
+      rem.SetNoiseDbm (NoiseDbm (numerology.BandwidthHz (), DoubleDefault ("ns3::MmWaveUePhy", "NoiseFigure")));
+      rem.SetGainDb (bfGain);
+      for (uint32_t e = 0; e < enbNodes.GetN (); ++e)
+        {
+          rem.AddTransmitter (enbNodes.Get (e)->GetObject<MobilityModel> (), 0,
+                              DoubleDefault ("ns3::MmWaveEnbPhy", "TxPower"));
+        }
+    }
+
+  //Compute the tiles, then the exports from the raster
+  NS_LOG_INFO ("REM of " << rem.GetNumPoints () << " points in tiles of " << tileSize << "x" << tileSize
+               << " over " << workers << " workers");
+  SystemWallClockMs clock;
+  clock.Start ();
+  rem.Run ("REM" + name + ".rem", tileSize, workers);
+  int64_t wallMs = clock.End ();
+  RemTiles::ExportCsv ("REM" + name + ".rem", "REM" + name + ".csv");
+  RemTiles::ExportPgm ("REM" + name + ".rem", "REM" + name + ".pgm", minDb, maxDb);
+
+  std::cout << "REM " << name << ": " << rem.GetNumPoints () << " points, " << workers << " workers\n";
+  std::cout << " Wall Clock: " << wallMs << " ms\n";
+  std::cout << " Coverage: " << 100 * RemTiles::Coverage ("REM" + name + ".rem", coverageSinr)
+            << " % of points at " << coverageSinr << " dB SINR or more\n";
+
+  Simulator::Destroy ();
+  return 0;
+}
@@ -0,0 +1,200 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//Latency under load over 4G: one UE pings an echo server with small UDP
+//probes, first on an idle link and then while a saturating TCP download
+//(or upload) runs on the same bearer. Reports the idle and loaded RTT
+//distributions of the probes and the responsiveness in round trips per
+//minute, to compare with mmwaveResponsiveness.
+
+//Import libraries
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/lte-module.h"
+#include "ns3/config-store.h"
+#include <ns3/buildings-helper.h>
+#include "ns3/internet-stack-helper.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/applications-module.h"
+#include "ns3/flow-monitor-helper.h"
+#include "ns3/ipv4-flow-classifier.h"
+
+#include "flow-metrics.h"
+#include "epc-topology.h"
+#include "scheduler-stats.h"
+#include "rlc-queue-stats.h"
+#include "server-aqm.h"
+#include "responsiveness.h"
+
+//Define namespace
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("Responsiveness");
+
+//Checking for lost packets as part of the Flow Monitor
+ void
+ FlowMonitor::CheckForLostPackets (Time maxDelay)
+ {
+   NS_LOG_FUNCTION (this << maxDelay.GetSeconds ());
+   Time now = Simulator::Now ();
+
+   for (TrackedPacketMap::iterator iter = m_trackedPackets.begin ();
+        iter != m_trackedPackets.end (); )
+     {
+       if (now - iter->second.lastSeenTime >= maxDelay)
+         {
+           // packet is considered lost, add it to the loss statistics
+           FlowStatsContainerI flow = m_flowStats.find (iter->first.first);
+           NS_ASSERT (flow != m_flowStats.end ());
+           flow->second.lostPackets++;
+
+           // we won't track it anymore
+           m_trackedPackets.erase (iter++);
+         }
+       else
+         {
+           iter++;
+         }
+     }
+ }
+
+//Main function
+int main (int argc, char *argv[])
+{
+  //Defaults if none given at runtime
+  double simTime = 20.0;
+  double idleTime = 5.0; //probes alone before the load starts [s]
+  double distance = 50.0; //of the UE from the eNB [m]
+  std::string load = "download"; //saturating TCP flow: download or upload
+  double probeInterval = 0.1; //[s]
+  uint32_t probeSize = 64; //bytes of UDP payload
+  std::string rlcMode = "default"; //RLC of the bearers: default, um or am
+  uint32_t rlcBuffer = 0; //RLC transmit buffer [bytes], 0 keeps the default
+  std::string aqm = "none"; //queue disc on the server link: none, fqcodel, pie or red
+  std::string scheduler = "pf"; //LTE MAC scheduler
+
+  //Command line arguments, overrides defaults if given
+  CommandLine cmd;
+  cmd.AddValue ("simTime", "Total duration of the simulation", simTime);
+  cmd.AddValue ("idleTime", "Time the probes run on an idle link before the load starts [s]", idleTime);
+  cmd.AddValue ("distance", "Distance of the UE from the eNB [m]", distance);
+  cmd.AddValue ("load", "Saturating TCP flow on the UE: download or upload", load);
+  cmd.AddValue ("probeInterval", "Interval between probes [s]", probeInterval);
+  cmd.AddValue ("probeSize", "UDP payload of a probe [bytes]", probeSize);
+  cmd.AddValue ("rlcMode", "RLC mode of the bearers: default, um or am", rlcMode);
+  cmd.AddValue ("rlcBuffer", "RLC transmit buffer of every bearer [bytes], 0 keeps the default", rlcBuffer);
+  cmd.AddValue ("aqm", "Queue disc on both ends of the server link: none (pfifo_fast), fqcodel, pie or red", aqm);
+  cmd.AddValue ("scheduler", "LTE MAC scheduler: pf, rr, tdmt, fdmt, tta, tdbet, fdbet, tdtbfq, fdtbfq, pss or cqa", scheduler);
+  cmd.Parse (argc, argv);
+
+  LogComponentEnable ("Responsiveness", LOG_INFO);
+
+  NS_ABORT_MSG_IF (load != "download" && load != "upload", "Unknown load " << load << ", use download or upload");
+  NS_ABORT_MSG_IF (idleTime <= 0 || simTime <= 2.0 + idleTime, "The simulation must outlast the idle phase");
+
+  //Initialising the ltehelper function
+  Ptr<LteHelper> lteHelper = CreateObject<LteHelper> ();
+  //The server is a remote host behind the PGW, so the traffic crosses the bearers
+  Ptr<PointToPointEpcHelper> epcHelper = CreateObject<PointToPointEpcHelper> ();
+  lteHelper->SetEpcHelper (epcHelper);
+  lteHelper->SetSchedulerType (LteSchedulerType (scheduler));
+
+  // Create Nodes: 1 eNodeB, 1 UE and 1 server
+  NodeContainer enbNodes;
+  NodeContainer clientServerNodes;
+  enbNodes.Create (1);
+  clientServerNodes.Create (2);
+
+  // Install Mobility Model
+  MobilityHelper mobility;
+    //set non moving enb and ue nodes
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (enbNodes);
+  mobility.Install (clientServerNodes.Get (0));
+  clientServerNodes.Get (0)->GetObject<MobilityModel> ()->SetPosition (Vector (distance, 0.0, 0.0));
+  BuildingsHelper::Install (enbNodes);
+  BuildingsHelper::Install (clientServerNodes.Get (0));
+
+  // Create Devices and install them in the Nodes (eNB and UE)
+  NetDeviceContainer enbDevs = lteHelper->InstallEnbDevice (enbNodes);
+  //RLC of the bearers the EPC sets up on attach
+  ConfigureRlc (rlcMode, rlcBuffer);
+  NetDeviceContainer ueDevs = lteHelper->InstallUeDevice (clientServerNodes.Get (0));
+
+  //Create P2P link between the PGW and the server
+  PointToPointHelper pointToPoint;
+  //Set P2P attributes
+  pointToPoint.SetDeviceAttribute ("DataRate", StringValue ("60Mbps"));
+  pointToPoint.SetChannelAttribute ("Delay", StringValue ("30ms"));
+
+  //Use the internet stack helper and install on the ue and server nodes
+  InternetStackHelper internet;
+  internet.Install (clientServerNodes);
+
+  //Assigning IP addresses, the server gets one on the PGW link and the UE one from the EPC
+  Address serverAddress = ConnectRemoteHost (epcHelper, clientServerNodes.Get (1), pointToPoint, false);
+  //Queue disc on both ends of the server link
+  ServerAqm serverAqm (aqm);
+  serverAqm.Install (epcHelper, clientServerNodes.Get (1), "ServerQueueResponsiveness.csv", Seconds (0));
+  std::vector<Address> ueAddresses = AssignUeAddresses (epcHelper, NodeContainer (clientServerNodes.Get (0)), ueDevs, false);
+
+  // Attach a UE to a eNB once it has an address, the EPC sets up the default bearer
+  lteHelper->Attach (ueDevs, enbDevs.Get (0));
+
+  // Probes from 2s, both flows share the default bearer
+  Time loadStart = Seconds (2.0 + idleTime);
+  ResponsivenessProbe probe ("ProbesResponsiveness.csv", Seconds (probeInterval), probeSize, loadStart);
+  probe.Install (clientServerNodes.Get (0), clientServerNodes.Get (1), serverAddress, 50001, Seconds (2.0), Seconds (simTime));
+
+  // Saturating TCP flow, a bulk sender with no byte limit
+  bool download = load == "download";
+  uint16_t port = 50000;
+  Ptr<Node> sender = clientServerNodes.Get (download ? 1 : 0);
+  Ptr<Node> receiver = clientServerNodes.Get (download ? 0 : 1);
+  PacketSinkHelper sinkHelper ("ns3::TcpSocketFactory", AnySocketAddress (false, port));
+  sinkHelper.Install (receiver).Start (Seconds (1.0));
+  BulkSendHelper bulk ("ns3::TcpSocketFactory", SocketAddress (download ? ueAddresses[0] : serverAddress, port));
+  bulk.SetAttribute ("MaxBytes", UintegerValue (0));
+  bulk.Install (sender).Start (loadStart);
+
+// Flow monitor
+Ptr<FlowMonitor> flowMonitor;
+FlowMonitorHelper flowHelper;
+flowMonitor = flowHelper.Install (clientServerNodes); //end hosts only, the EPC nodes would report the GTP tunnels
+//Specifying histogram bin widths for delay, jitter and packet size
+flowMonitor->SetAttribute("DelayBinWidth", DoubleValue(0.001));
+flowMonitor->SetAttribute("JitterBinWidth", DoubleValue(0.001));
+flowMonitor->SetAttribute("PacketSizeBinWidth", DoubleValue(20));
+
+//Running and Stopping simulation
+  Simulator::Stop (Seconds (simTime));
+  Simulator::Run ();
+
+//Callback to class, checks for packets that appear to be lost
+flowMonitor->CheckForLostPackets();
+
+//Print the TCP load and the probes of each flow, then the probe RTTs idle and loaded
+PrintFlowMetrics (flowMonitor, flowHelper);
+serverAqm.Print ();
+probe.Print ();
+
+//Flow monitor file generation
+flowMonitor->SerializeToXmlFile("FlowMonitorResponsiveness.xml", true, true); //histograms and probes enabled
+
+  Simulator::Destroy ();
+  return 0;
+}
@@ -32,23 +32,20 @@
 #include "ns3/flow-monitor-helper.h"
 #include "ns3/ipv4-flow-classifier.h"
 
+#include "flow-metrics.h"
+#include "ue-energy-model.h"
+#include "epc-topology.h"
+#include "bearer-config.h"
+#include "background-load.h"
+#include "link-quality-recorder.h"
+#include "building-grid.h"
+#include "carrier-aggregation.h"
+#include "scheduler-stats.h"
+#include "rlc-queue-stats.h"
+
 //Define namespace
 using namespace ns3;
 
-//Print remaining energy function
-//static void PrintCellInfo (liIonSourceHelper)
-//{
-//   std::cout << "At " << Simulator::Now ().GetSeconds () << " Cell voltage: " << liIonSourceHelper->GetSupplyVoltage () << " V Remaining Capacity: " <<
-//   liIonSourceHelper->GetRemainingEnergy () / (3.7 * 3600) << " Ah" << std::endl; 
-// 
-//  if (!Simulator::IsFinished ())
-//        {
-//          Simulator::Schedule (Seconds (10),
-//                               &PrintCellInfo,
-//                               liIonSourceHelper);
-//        }
-//}
-
 NS_LOG_COMPONENT_DEFINE ("TCPRandomWalk");
 
 //Checking for lost packets as part of the Flow Monitor
@@ -85,6 +82,21 @@ int main (int argc, char *argv[])
   //Defaults if none given at runtime
   double simTime = 30.0;
   bool useCa = false;
+  uint16_t numCcs = 2; //component carriers with useCa
+  uint16_t ccBandwidth = 25; //per carrier, in RBs
+  std::string ccManager = "rr"; //round robin split over the carriers
+  uint32_t qci = 0;
+  std::string bearers = "";
+  std::string direction = "ul"; //which end sends: ul, dl or both
+  uint32_t bgUes = 0; //background UEs loading the cell
+  double bgLoad = 0.7; //share of the cell rate they offer
+  std::string bgTraffic = "cbr";
+  std::string rlcMode = "default"; //RLC of the bearers: default, um or am
+  uint32_t rlcBuffer = 0; //RLC transmit buffer [bytes], 0 keeps the default
+  double rlcWindow = 0.1; //RLC queue sample interval [s], 0 disables
+  double linkWindow = 0.1; //per-UE link quality record interval [s], 0 disables
+  BuildingGrid grid = DefaultBuildingGrid (); //open space unless buildingBlocks is set
+  std::string scheduler = "pf"; //LTE MAC scheduler
   bool useV6 = false;
  
   Address serverAddress;
@@ -93,7 +105,26 @@ int main (int argc, char *argv[])
   CommandLine cmd;
   cmd.AddValue ("simTime", "Total duration of the simulation", simTime);
   cmd.AddValue ("useCa", "Whether to use carrier aggregation.", useCa);
+  cmd.AddValue ("numCcs", "Number of component carriers with carrier aggregation", numCcs);
+  cmd.AddValue ("ccBandwidth", "RBs of each component carrier: 6, 15, 25, 50, 75 or 100", ccBandwidth);
+  cmd.AddValue ("ccManager", "Carrier manager: rr (equal split), load (split by free PRBs) or noop (primary carrier only)", ccManager);
   cmd.AddValue ("useV6", "Whether to use IPv6 or not.", useV6);
+  cmd.AddValue ("qci", "QCI of the traffic bearer, 0 picks the one for the traffic type", qci);
+  cmd.AddValue ("bearers", "Extra dedicated bearers as qci:port or qci:firstPort-lastPort, comma separated", bearers);
+  cmd.AddValue ("direction", "Which end sends: ul (UE to server), dl (server to UE) or both", direction);
+  cmd.AddValue ("bgUes", "Number of background UEs loading the cell", bgUes);
+  cmd.AddValue ("bgLoad", "Share of the cell rate offered by the background UEs", bgLoad);
+  cmd.AddValue ("bgTraffic", "Background traffic: fullbuffer, cbr or poisson", bgTraffic);
+  cmd.AddValue ("rlcMode", "RLC mode of the bearers: default, um or am", rlcMode);
+  cmd.AddValue ("rlcBuffer", "RLC transmit buffer of every bearer [bytes], 0 keeps the default", rlcBuffer);
+  cmd.AddValue ("rlcWindow", "Interval of the RLC queue occupancy and sojourn records [s], 0 disables them", rlcWindow);
+  cmd.AddValue ("linkWindow", "Interval of the per-UE SINR/CQI/MCS/PRB records [s], 0 disables them", linkWindow);
+  cmd.AddValue ("buildingBlocks", "Blocks per side of the urban grid around the eNB, 0 for open space", grid.blocks);
+  cmd.AddValue ("blockSize", "Side of a building block [m]", grid.blockSize);
+  cmd.AddValue ("streetWidth", "Width of the streets between the blocks [m]", grid.streetWidth);
+  cmd.AddValue ("floors", "Floors of every building", grid.floors);
+  cmd.AddValue ("wallLoss", "Loss of the external walls of the buildings [dB]", grid.wallLossDb);
+  cmd.AddValue ("scheduler", "LTE MAC scheduler: pf, rr, tdmt, fdmt, tta, tdbet, fdbet, tdtbfq, fdtbfq, pss or cqa", scheduler);
   cmd.Parse (argc, argv);
  
   LogComponentEnable ("TCPRandomWalk", LOG_INFO);
@@ -101,16 +132,21 @@ int main (int argc, char *argv[])
   // Parse again so you can override default values from the command line
   cmd.Parse (argc, argv);
 
+  //Which ends send, aborts on an unknown direction
+  TrafficDirection trafficDirection = ParseDirection (direction);
+
   //If user carrier aggregation is set to true via the command line...
   if (useCa)
    {
-     Config::SetDefault ("ns3::LteHelper::UseCa", BooleanValue (useCa)); //enable carrier aggregation
-     Config::SetDefault ("ns3::LteHelper::NumberOfComponentCarriers", UintegerValue (2)); //set number of component carriers to 2
-     Config::SetDefault ("ns3::LteHelper::EnbComponentCarrierManager", StringValue ("ns3::RrComponentCarrierManager")); //split traffic equally among carriers
+     ConfigureLteCa (numCcs, ccBandwidth, ccManager); //carriers of ccBandwidth RBs, split by ccManager
    }
 
   //Initialising the ltehelper function
   Ptr<LteHelper> lteHelper = CreateObject<LteHelper> ();
+  //The server is a remote host behind the PGW, so the traffic crosses the bearers
+  Ptr<PointToPointEpcHelper> epcHelper = CreateObject<PointToPointEpcHelper> ();
+  lteHelper->SetEpcHelper (epcHelper);
+  lteHelper->SetSchedulerType (LteSchedulerType (scheduler));
 
   // Uncomment to enable logging
 //  lteHelper->EnableLogComponents ();
@@ -143,48 +179,79 @@ int main (int argc, char *argv[])
   mobility.Install (clientServerNodes.Get(0));
   BuildingsHelper::Install (clientServerNodes.Get(0));
 
+  //Urban grid around the eNB, the links of indoor nodes cross the walls
+  CreateBuildingGrid (grid);
+  Ptr<BuildingPenetrationLossModel> buildingLoss = InstallBuildingLoss (lteHelper, grid); //before the channels exist
+
   // Create Devices and install them in the Nodes (eNB and UE)
   NetDeviceContainer enbDevs;
   NetDeviceContainer ueDevs;
 
   enbDevs = lteHelper->InstallEnbDevice (enbNodes);
+  //RLC of the bearers the EPC sets up on attach
+  uint32_t rlcBufferBytes = ConfigureRlc (rlcMode, rlcBuffer);
   ueDevs = lteHelper->InstallUeDevice (clientServerNodes.Get (0));
 
-  // Attach a UE to a eNB
-  lteHelper->Attach (ueDevs, enbDevs.Get (0));
-
-  // Activate a data radio bearer
-  enum EpsBearer::Qci q = EpsBearer::GBR_CONV_VOICE;
-  EpsBearer bearer (q);
-  lteHelper->ActivateDataRadioBearer (ueDevs, bearer);
+  //Background UEs within 100m, loading the peak rate of all carriers
+  BackgroundLoad background (bgUes, bgLoad, bgTraffic, useCa ? numCcs * LtePeakDlMbps (ccBandwidth) : LtePeakDlMbps (25));
+  NetDeviceContainer bgDevs = lteHelper->InstallUeDevice (background.CreateUes (enbNodes.Get (0), 100.0));
 
-  //Create P2P link
+  //Create P2P link between the PGW and the server
   PointToPointHelper pointToPoint;
   //Set P2P attributes
   pointToPoint.SetDeviceAttribute ("DataRate", StringValue ("60Mbps"));
   pointToPoint.SetChannelAttribute ("Delay", StringValue ("30ms"));
-  //install on client/server nodes
-  NetDeviceContainer clientServerDevs;
-  clientServerDevs = pointToPoint.Install (clientServerNodes);
   
   //Use the internet stack helper and install on the ue nodes
   InternetStackHelper internet;
   internet.Install (clientServerNodes);
   
-  //Assigning IPv4 addresses onto client/server nodes
-  Ipv4AddressHelper ipv4;
-  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
-  Ipv4InterfaceContainer i = ipv4.Assign (clientServerDevs);
-  serverAddress = Address (i.GetAddress (1));
-  
-  // Create a packet sink to receive packets from OnOff application
+  //Assigning IP addresses, the server gets one on the PGW link and the UE one from the EPC
   uint16_t port = 50000;
-  Address sinkAddress (InetSocketAddress (i.GetAddress (1), port));
-  PacketSinkHelper sinkHelper ("ns3::TcpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), port));
-  ApplicationContainer sinkApp = sinkHelper.Install (clientServerNodes.Get(1));
+  serverAddress = ConnectRemoteHost (epcHelper, clientServerNodes.Get (1), pointToPoint, useV6);
+  std::vector<Address> ueAddresses = AssignUeAddresses (epcHelper, NodeContainer (clientServerNodes.Get (0)), ueDevs, useV6);
+  background.Install (epcHelper, bgDevs, pointToPoint, useV6, Seconds (1.0)); //own remote host, not in the flow monitor
+
+  // Attach a UE to a eNB once it has an address, the EPC sets up the default bearer
+  lteHelper->Attach (ueDevs, enbDevs.Get (0));
+  lteHelper->Attach (bgDevs, enbDevs.Get (0));
+  background.MonitorLtePrbs (enbDevs);
+  SchedulerStats schedulerStats (scheduler);
+  schedulerStats.Install (enbDevs, Seconds (1.0));
+  LinkQualityRecorder linkQuality ("LinkQualityTCPRandomWalk.csv", Seconds (linkWindow));
+  if (linkWindow > 0)
+    {
+      linkQuality.InstallLte (enbDevs);
+    }
+  RlcQueueStats rlcQueues ("RlcQueueTCPRandomWalk.csv", Seconds (rlcWindow), rlcBufferBytes);
+  if (rlcWindow > 0)
+    {
+      rlcQueues.Install (Seconds (1.0));
+    }
+  CarrierStats carrierStats;
+  if (useCa)
+    {
+      carrierStats.InstallLte (enbDevs, Seconds (1.0));
+    }
+
+  // Activate a dedicated bearer with the QCI of the traffic type, plus any extra ones
+  ActivateBearers (lteHelper, ueDevs, TrafficBearers ("tcp", qci, port, bearers));
+
+  // Create a packet sink on each receiver, the server for UL and the UE for DL
+  Address sinkAddress = SocketAddress (serverAddress, port);
+  PacketSinkHelper sinkHelper ("ns3::TcpSocketFactory", AnySocketAddress (useV6, port));
+  ApplicationContainer sinkApp;
+  if (trafficDirection.ul)
+    {
+      sinkApp.Add (sinkHelper.Install (clientServerNodes.Get(1)));
+    }
+  if (trafficDirection.dl)
+    {
+      sinkApp.Add (sinkHelper.Install (clientServerNodes.Get(0)));
+    }
   sinkApp.Start (Seconds (1.0));
 
-  // Create the OnOff applications to send TCP packets to the server
+  // Create the OnOff applications to send TCP packets to the other end
    uint32_t MaxPacketSize = 1024; //size of each packet in bytes
    OnOffHelper client ("ns3::TcpSocketFactory", sinkAddress);
    client.SetAttribute ("OnTime", StringValue ("ns3::ConstantRandomVariable[Constant=1]"));
@@ -192,32 +259,26 @@ int main (int argc, char *argv[])
    client.SetAttribute ("DataRate", DataRateValue (DataRate ("60Mbps")));
    client.SetAttribute ("PacketSize", UintegerValue (MaxPacketSize));
    client.SetAttribute ("MaxBytes", UintegerValue (10000));
-   ApplicationContainer clientApp = client.Install (clientServerNodes.Get (0));
+   ApplicationContainer clientApp;
+   if (trafficDirection.ul)
+     {
+       clientApp.Add (client.Install (clientServerNodes.Get (0)));
+     }
+   client.SetAttribute ("Remote", AddressValue (SocketAddress (ueAddresses[0], port)));
+   if (trafficDirection.dl)
+     {
+       clientApp.Add (client.Install (clientServerNodes.Get (1)));
+     }
    clientApp.Start (Seconds (2.0));
 
-/*
-   // energy source //
-   BasicEnergySourceHelper basicSourceHelper;
-   // configure energy source
-   basicSourceHelper.Set ("BasicEnergySourceInitialEnergyJ", DoubleValue (1.0));
-   // install source
-   EnergySourceContainer sources;
-   sources = basicSourceHelper.Install (clientServerNodes.Get(0));
-   // device energy model //
+   //UE battery, 3000 mAh and 3.7V is average mobile phone
    LiIonEnergySourceHelper liIonSourceHelper;
-   liIonSourceHelper.Set("LiIonEnergySourceInitialEnergyJ",
-                          DoubleValue(35000.00));
-   liIonSourceHelper.Set("InitialCellVoltage",
-                          DoubleValue(3.7));
-   liIonSourceHelper.Set("PeriodicEnergyUpdateInterval",
-                          TimeValue (Seconds(1.0)));
-*/
-
-//   DeviceEnergyModelContainer deviceModels = liIonSourceHelper.Install (ueDevs, sources);
-
-   //3000 mAh and 3.7V is average mobile phone
-
-//  PrintCellInfo (liIonSourceHelper);
+   liIonSourceHelper.Set ("LiIonEnergySourceInitialEnergyJ", DoubleValue (35000.00));
+   liIonSourceHelper.Set ("InitialCellVoltage", DoubleValue (3.7));
+   //the radio model updates the source on every RRC/DRX state change, no polling needed
+   liIonSourceHelper.Set ("PeriodicEnergyUpdateInterval", TimeValue (Seconds (simTime)));
+   EnergySourceContainer sources = liIonSourceHelper.Install (clientServerNodes.Get (0));
+   Ptr<UeRadioEnergyModel> ueEnergy = InstallUeRadioEnergyModel (clientServerNodes.Get (0), sources.Get (0));
 
 //LTE ALL tracing
 lteHelper->EnableTraces (); //creates Dl* and Ul* files
@@ -237,7 +298,7 @@ pointToPoint.EnablePcapAll ("PCAPTCPRandomWalk"); //pcap
 // Flow monitor
 Ptr<FlowMonitor> flowMonitor;
 FlowMonitorHelper flowHelper;
-flowMonitor = flowHelper.InstallAll();
+flowMonitor = flowHelper.Install (clientServerNodes); //end hosts only, the EPC nodes would report the GTP tunnels
 //Specifying histogram bin widths for delay, jitter and packet size
 flowMonitor->SetAttribute("DelayBinWidth", DoubleValue(0.001));
 flowMonitor->SetAttribute("JitterBinWidth", DoubleValue(0.001));
@@ -247,27 +308,26 @@ flowMonitor->SetAttribute("PacketSizeBinWidth", DoubleValue(20));
 //Running and Stopping simulation
   //Simulator::Stop (Seconds (simTime));
   Simulator::Stop (Seconds (simTime));
+  schedulerStats.StartClock ();
   Simulator::Run ();
+  schedulerStats.StopClock ();
 
 //Callback to class, checks for packets that appear to be lost
 flowMonitor->CheckForLostPackets();
 
-//Only show flow, transferred bytes, received bytes and throughput
-Ptr<Ipv4FlowClassifier> classifier = DynamicCast<Ipv4FlowClassifier> (flowHelper.GetClassifier ());
-
-FlowMonitor::FlowStatsContainer stats = flowMonitor->GetFlowStats ();
-
-//std::map<FlowId, FlowMonitor::FlowStats> stats = flowMonitor->GetFlowStats ();
-for (std::map<FlowId, FlowMonitor::FlowStats>::const_iterator i = stats.begin (); i != stats.end (); ++i)
-{
-	Ipv4FlowClassifier::FiveTuple t = classifier->FindFlow (i->first);
-	std::cout << "Flow " << i->first << " (" << t.sourceAddress << " -> " << t.destinationAddress << ")\n";
-	std::cout << " Tx Bytes: " << i->second.txBytes << "\n";
-	std::cout << " Rx Bytes: " << i->second.rxBytes << "\n";
-	std::cout << " Throughput: " << i->second.rxBytes * 8.0 / (i->second.timeLastRxPacket.GetSeconds() - i->second.timeFirstTxPacket.GetSeconds())/1024/1024 << " Mbps\n";
-	std::cout << " Delay: " << i->second.delaySum << "\n";
-	std::cout << " Lost Packets: " << i->second.lostPackets << "\n";
-}
+//Print goodput, delay percentiles, jitter and loss for each IPv4/IPv6 flow (SI units)
+PrintFlowMetrics (flowMonitor, flowHelper);
+PrintDirectionMetrics (flowMonitor, flowHelper, clientServerNodes.Get (0));
+PrintUeEnergy (flowMonitor, flowHelper, ueEnergy);
+background.Print ();
+rlcQueues.Finish ();
+linkQuality.Finish ();
+PrintBuildingGrid (grid, buildingLoss);
+schedulerStats.Print ();
+if (useCa)
+  {
+    carrierStats.Print ();
+  }
 
 //Flow monitor file generation
 flowMonitor->SerializeToXmlFile("FlowMonitorTCPRandomWalk.xml", true, true); //histograms and probes enabled
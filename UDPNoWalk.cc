@@ -32,23 +32,18 @@
 #include "ns3/flow-monitor-helper.h"
 #include "ns3/ipv4-flow-classifier.h"
 
+#include "flow-metrics.h"
+#include "ue-energy-model.h"
+#include "epc-topology.h"
+#include "bearer-config.h"
+#include "background-load.h"
+#include "building-grid.h"
+#include "carrier-aggregation.h"
+#include "scheduler-stats.h"
+
 //Define namespace
 using namespace ns3;
 
-//Print remaining energy function
-//static void PrintCellInfo (liIonSourceHelper)
-//{
-//   std::cout << "At " << Simulator::Now ().GetSeconds () << " Cell voltage: " << liIonSourceHelper->GetSupplyVoltage () << " V Remaining Capacity: " <<
-//   liIonSourceHelper->GetRemainingEnergy () / (3.7 * 3600) << " Ah" << std::endl; 
-// 
-//  if (!Simulator::IsFinished ())
-//        {
-//          Simulator::Schedule (Seconds (10),
-//                               &PrintCellInfo,
-//                               liIonSourceHelper);
-//        }
-//}
-
 NS_LOG_COMPONENT_DEFINE ("UDPRandomWalk");
 
 //Checking for lost packets as part of the Flow Monitor
@@ -84,6 +79,17 @@ int main (int argc, char *argv[])
   //Defaults if none given at runtime
   double simTime = 10.0;
   bool useCa = false;
+  uint16_t numCcs = 2; //component carriers with useCa
+  uint16_t ccBandwidth = 25; //per carrier, in RBs
+  std::string ccManager = "rr"; //round robin split over the carriers
+  uint32_t qci = 0;
+  std::string bearers = "";
+  std::string direction = "ul"; //which end sends: ul, dl or both
+  uint32_t bgUes = 0; //background UEs loading the cell
+  double bgLoad = 0.7; //share of the cell rate they offer
+  std::string bgTraffic = "cbr";
+  BuildingGrid grid = DefaultBuildingGrid (); //open space unless buildingBlocks is set
+  std::string scheduler = "pf"; //LTE MAC scheduler
   bool useV6 = false;
  
   Address serverAddress;
@@ -92,7 +98,22 @@ int main (int argc, char *argv[])
   CommandLine cmd;
   cmd.AddValue ("simTime", "Total duration of the simulation", simTime);
   cmd.AddValue ("useCa", "Whether to use carrier aggregation.", useCa);
+  cmd.AddValue ("numCcs", "Number of component carriers with carrier aggregation", numCcs);
+  cmd.AddValue ("ccBandwidth", "RBs of each component carrier: 6, 15, 25, 50, 75 or 100", ccBandwidth);
+  cmd.AddValue ("ccManager", "Carrier manager: rr (equal split), load (split by free PRBs) or noop (primary carrier only)", ccManager);
   cmd.AddValue ("useV6", "Whether to use IPv6 or not.", useV6);
+  cmd.AddValue ("qci", "QCI of the traffic bearer, 0 picks the one for the traffic type", qci);
+  cmd.AddValue ("bearers", "Extra dedicated bearers as qci:port or qci:firstPort-lastPort, comma separated", bearers);
+  cmd.AddValue ("direction", "Which end sends: ul (UE to server), dl (server to UE) or both", direction);
+  cmd.AddValue ("bgUes", "Number of background UEs loading the cell", bgUes);
+  cmd.AddValue ("bgLoad", "Share of the cell rate offered by the background UEs", bgLoad);
+  cmd.AddValue ("bgTraffic", "Background traffic: fullbuffer, cbr or poisson", bgTraffic);
+  cmd.AddValue ("buildingBlocks", "Blocks per side of the urban grid around the eNB, 0 for open space", grid.blocks);
+  cmd.AddValue ("blockSize", "Side of a building block [m]", grid.blockSize);
+  cmd.AddValue ("streetWidth", "Width of the streets between the blocks [m]", grid.streetWidth);
+  cmd.AddValue ("floors", "Floors of every building", grid.floors);
+  cmd.AddValue ("wallLoss", "Loss of the external walls of the buildings [dB]", grid.wallLossDb);
+  cmd.AddValue ("scheduler", "LTE MAC scheduler: pf, rr, tdmt, fdmt, tta, tdbet, fdbet, tdtbfq, fdtbfq, pss or cqa", scheduler);
   cmd.Parse (argc, argv);
  
   LogComponentEnable ("UDPRandomWalk", LOG_INFO);
@@ -100,16 +121,21 @@ int main (int argc, char *argv[])
   // Parse again so you can override default values from the command line
   cmd.Parse (argc, argv);
 
+  //Which ends send, aborts on an unknown direction
+  TrafficDirection trafficDirection = ParseDirection (direction);
+
   //If user carrier aggregation is set to true via the command line...
   if (useCa)
    {
-     Config::SetDefault ("ns3::LteHelper::UseCa", BooleanValue (useCa)); //enable carrier aggregation
-     Config::SetDefault ("ns3::LteHelper::NumberOfComponentCarriers", UintegerValue (2)); //set number of component carriers to 2
-     Config::SetDefault ("ns3::LteHelper::EnbComponentCarrierManager", StringValue ("ns3::RrComponentCarrierManager")); //split traffic equally among carriers
+     ConfigureLteCa (numCcs, ccBandwidth, ccManager); //carriers of ccBandwidth RBs, split by ccManager
    }
 
   //Initialising the ltehelper function
   Ptr<LteHelper> lteHelper = CreateObject<LteHelper> ();
+  //The server is a remote host behind the PGW, so the traffic crosses the bearers
+  Ptr<PointToPointEpcHelper> epcHelper = CreateObject<PointToPointEpcHelper> ();
+  lteHelper->SetEpcHelper (epcHelper);
+  lteHelper->SetSchedulerType (LteSchedulerType (scheduler));
 
   // Uncomment to enable logging
 //  lteHelper->EnableLogComponents ();
@@ -131,6 +157,10 @@ int main (int argc, char *argv[])
   mobility.Install (clientServerNodes.Get(0));
   BuildingsHelper::Install (clientServerNodes.Get(0));
 
+  //Urban grid around the eNB, the links of indoor nodes cross the walls
+  CreateBuildingGrid (grid);
+  Ptr<BuildingPenetrationLossModel> buildingLoss = InstallBuildingLoss (lteHelper, grid); //before the channels exist
+
   // Create Devices and install them in the Nodes (eNB and UE)
   NetDeviceContainer enbDevs;
   NetDeviceContainer ueDevs;
@@ -138,50 +168,55 @@ int main (int argc, char *argv[])
   enbDevs = lteHelper->InstallEnbDevice (enbNodes);
   ueDevs = lteHelper->InstallUeDevice (clientServerNodes.Get (0));
 
-  // Attach a UE to a eNB
-  lteHelper->Attach (ueDevs, enbDevs.Get (0));
-
-  // Activate a data radio bearer
-  enum EpsBearer::Qci q = EpsBearer::GBR_CONV_VOICE;
-  EpsBearer bearer (q);
-  lteHelper->ActivateDataRadioBearer (ueDevs, bearer);
+  //Background UEs within 100m, loading the peak rate of all carriers
+  BackgroundLoad background (bgUes, bgLoad, bgTraffic, useCa ? numCcs * LtePeakDlMbps (ccBandwidth) : LtePeakDlMbps (25));
+  NetDeviceContainer bgDevs = lteHelper->InstallUeDevice (background.CreateUes (enbNodes.Get (0), 100.0));
 
-  //Create P2P link
+  //Create P2P link between the PGW and the server
   PointToPointHelper pointToPoint;
   //Set P2P attributes
   pointToPoint.SetDeviceAttribute ("DataRate", StringValue ("60Mbps"));
   pointToPoint.SetChannelAttribute ("Delay", StringValue ("30ms"));
-  //install on client/server nodes
-  NetDeviceContainer clientServerDevs;
-  clientServerDevs = pointToPoint.Install (clientServerNodes);
   
   //Use the internet stack helper and install on the ue nodes
   InternetStackHelper internet;
   internet.Install (clientServerNodes);
   
-  //Assigning IP addresses
-  if (useV6 == false)
+  //Assigning IP addresses, the server gets one on the PGW link and the UE one from the EPC
+  uint16_t port = 50000;
+  serverAddress = ConnectRemoteHost (epcHelper, clientServerNodes.Get (1), pointToPoint, useV6);
+  std::vector<Address> ueAddresses = AssignUeAddresses (epcHelper, NodeContainer (clientServerNodes.Get (0)), ueDevs, useV6);
+  background.Install (epcHelper, bgDevs, pointToPoint, useV6, Seconds (1.0)); //own remote host, not in the flow monitor
+
+  // Attach a UE to a eNB once it has an address, the EPC sets up the default bearer
+  lteHelper->Attach (ueDevs, enbDevs.Get (0));
+  lteHelper->Attach (bgDevs, enbDevs.Get (0));
+  background.MonitorLtePrbs (enbDevs);
+  SchedulerStats schedulerStats (scheduler);
+  schedulerStats.Install (enbDevs, Seconds (1.0));
+  CarrierStats carrierStats;
+  if (useCa)
     {
-      Ipv4AddressHelper ipv4;
-      ipv4.SetBase ("10.1.1.0", "255.255.255.0");
-      Ipv4InterfaceContainer i = ipv4.Assign (clientServerDevs);
-      serverAddress = Address (i.GetAddress (1));
+      carrierStats.InstallLte (enbDevs, Seconds (1.0));
     }
-  else
+
+  // Activate a dedicated bearer with the QCI of the traffic type, plus any extra ones
+  ActivateBearers (lteHelper, ueDevs, TrafficBearers ("udp", qci, port, bearers));
+
+  // Create a UDP Server on each receiver, the server for UL and the UE for DL
+  UdpServerHelper server (port);
+  ApplicationContainer apps;
+  if (trafficDirection.ul)
     {
-      Ipv6AddressHelper ipv6;
-      ipv6.SetBase ("2001:0000:f00d:cafe::", Ipv6Prefix (64));
-      Ipv6InterfaceContainer i6 = ipv6.Assign (clientServerDevs);
-      serverAddress = Address(i6.GetAddress (1,1));
+      apps.Add (server.Install (clientServerNodes.Get(1)));
+    }
+  if (trafficDirection.dl)
+    {
+      apps.Add (server.Install (clientServerNodes.Get(0)));
     }
-  
-  // Create a UDP Server on the receiver
-  uint16_t port = 50000;
-  UdpServerHelper server (port);
-  ApplicationContainer apps = server.Install (clientServerNodes.Get(1));
   apps.Start (Seconds (1.0));
   
- // Create one UdpClient application to send UDP datagrams from node zero to node one.
+ // Create one UdpClient application per direction to send UDP datagrams to the other end.
    uint32_t MaxPacketSize = 1024; //size of each packet sent in bytes
    Time interPacketInterval = Seconds (0.05); // how often to send packets
    uint32_t maxPacketCount = 320; //max number of packets to send
@@ -189,32 +224,26 @@ int main (int argc, char *argv[])
    client.SetAttribute ("MaxPackets", UintegerValue (maxPacketCount));
    client.SetAttribute ("Interval", TimeValue (interPacketInterval));
    client.SetAttribute ("PacketSize", UintegerValue (MaxPacketSize));
-   apps = client.Install (clientServerNodes.Get (0));
+   apps = ApplicationContainer ();
+   if (trafficDirection.ul)
+     {
+       apps.Add (client.Install (clientServerNodes.Get (0)));
+     }
+   client.SetAttribute ("RemoteAddress", AddressValue (ueAddresses[0]));
+   if (trafficDirection.dl)
+     {
+       apps.Add (client.Install (clientServerNodes.Get (1)));
+     }
    apps.Start (Seconds (2.0));
 
-/*
-   // energy source //
-   BasicEnergySourceHelper basicSourceHelper;
-   // configure energy source
-   basicSourceHelper.Set ("BasicEnergySourceInitialEnergyJ", DoubleValue (1.0));
-   // install source
-   EnergySourceContainer sources;
-   sources = basicSourceHelper.Install (clientServerNodes.Get(0));
-   // device energy model //
+   //UE battery, 3000 mAh and 3.7V is average mobile phone
    LiIonEnergySourceHelper liIonSourceHelper;
-   liIonSourceHelper.Set("LiIonEnergySourceInitialEnergyJ",
-                          DoubleValue(35000.00));
-   liIonSourceHelper.Set("InitialCellVoltage",
-                          DoubleValue(3.7));
-   liIonSourceHelper.Set("PeriodicEnergyUpdateInterval",
-                          TimeValue (Seconds(1.0)));
-*/
-
-//   DeviceEnergyModelContainer deviceModels = liIonSourceHelper.Install (ueDevs, sources);
-
-   //3000 mAh and 3.7V is average mobile phone
-
-//  PrintCellInfo (liIonSourceHelper);
+   liIonSourceHelper.Set ("LiIonEnergySourceInitialEnergyJ", DoubleValue (35000.00));
+   liIonSourceHelper.Set ("InitialCellVoltage", DoubleValue (3.7));
+   //the radio model updates the source on every RRC/DRX state change, no polling needed
+   liIonSourceHelper.Set ("PeriodicEnergyUpdateInterval", TimeValue (Seconds (simTime)));
+   EnergySourceContainer sources = liIonSourceHelper.Install (clientServerNodes.Get (0));
+   Ptr<UeRadioEnergyModel> ueEnergy = InstallUeRadioEnergyModel (clientServerNodes.Get (0), sources.Get (0));
 
 //LTE ALL tracing
 lteHelper->EnableTraces (); //creates Dl* and Ul* files
@@ -233,7 +262,7 @@ pointToPoint.EnablePcapAll ("PCAPUDPRandomWalk"); //pcap
 // Flow monitor
 Ptr<FlowMonitor> flowMonitor;
 FlowMonitorHelper flowHelper;
-flowMonitor = flowHelper.InstallAll();
+flowMonitor = flowHelper.Install (clientServerNodes); //end hosts only, the EPC nodes would report the GTP tunnels
 //Specifying histogram bin widths for delay, jitter and packet size
 flowMonitor->SetAttribute("DelayBinWidth", DoubleValue(0.001));
 flowMonitor->SetAttribute("JitterBinWidth", DoubleValue(0.001));
@@ -242,24 +271,24 @@ flowMonitor->SetAttribute("PacketSizeBinWidth", DoubleValue(20));
 //Running and Stopping simulation
   //Simulator::Stop (Seconds (simTime));
   Simulator::Stop (Seconds (simTime));
+  schedulerStats.StartClock ();
   Simulator::Run ();
+  schedulerStats.StopClock ();
 
 //Callback to class, checks for packets that appear to be lost
 flowMonitor->CheckForLostPackets();
 
-//Only show flow, transferred bytes, received bytes and throughput
-Ptr<Ipv4FlowClassifier> classifier = DynamicCast<Ipv4FlowClassifier> (flowHelper.GetClassifier ());
-std::map<FlowId, FlowMonitor::FlowStats> stats = flowMonitor->GetFlowStats ();
-for (std::map<FlowId, FlowMonitor::FlowStats>::const_iterator i = stats.begin (); i != stats.end (); ++i)
-{
-Ipv4FlowClassifier::FiveTuple t = classifier->FindFlow (i->first);
-std::cout << "Flow " << i->first << " (" << t.sourceAddress << " -> " << t.destinationAddress << ")\n";
-std::cout << " Tx Bytes: " << i->second.txBytes << "\n";
-std::cout << " Rx Bytes: " << i->second.rxBytes << "\n";
-std::cout << " Throughput: " << i->second.rxBytes * 8.0 / (i->second.timeLastRxPacket.GetSeconds() - i->second.timeFirstTxPacket.GetSeconds())/1024/1024 << " Mbps\n";
-std::cout << " Delay: " << i->second.delaySum << "\n";
-std::cout << " Lost Packets: " << i->second.lostPackets << "\n";
-}
+//Print goodput, delay percentiles, jitter and loss for each IPv4/IPv6 flow (SI units)
+PrintFlowMetrics (flowMonitor, flowHelper);
+PrintDirectionMetrics (flowMonitor, flowHelper, clientServerNodes.Get (0));
+PrintUeEnergy (flowMonitor, flowHelper, ueEnergy);
+background.Print ();
+PrintBuildingGrid (grid, buildingLoss);
+schedulerStats.Print ();
+if (useCa)
+  {
+    carrierStats.Print ();
+  }
 
 //Flow monitor file generation
 flowMonitor->SerializeToXmlFile("FlowMonitorUDPRandomWalk.xml", true, true); //histograms and probes enabled
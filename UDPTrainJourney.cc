@@ -26,15 +26,33 @@
 #include "ns3/config-store.h"
 #include <ns3/buildings-helper.h>
 #include "ns3/a2-a4-rsrq-handover-algorithm.h"
+#include "ns3/a3-rsrp-handover-algorithm.h"
 #include "ns3/random-walk-2d-mobility-model.h"
 #include "ns3/netanim-module.h"
 #include "ns3/applications-module.h"
 #include "ns3/internet-module.h"
 #include "ns3/point-to-point-module.h"
+#include "ns3/flow-monitor-helper.h"
+#include "ns3/ipv4-flow-classifier.h"
+
+#include "flow-metrics.h"
+#include "anim-recorder.h"
+#include "handover-stats.h"
+#include "rail-corridor.h"
+#include "epc-topology.h"
+#include "bearer-config.h"
+#include "carrier-aggregation.h"
+#include "scheduler-stats.h"
+#include "link-quality-recorder.h"
+#include "sweep-file.h"
+
+#include <fstream>
 
 //Define namespace
 using namespace ns3;
 
+NS_LOG_COMPONENT_DEFINE ("UDPTrainJourney");
+
 //Arguments function
 int main (int argc, char *argv[])
 {
@@ -48,14 +66,36 @@ int main (int argc, char *argv[])
   */
 	
   //Defaults if none given at runtime
-  Time simTime = MilliSeconds (1050); //7,200,000 for 2 hours
+  Time simTime = Seconds (242); //one site distance at trainSpeed after the clients start at 2 s
   bool useCa = false;
+  uint16_t numCcs = 2; //component carriers with useCa
+  uint16_t ccBandwidth = 25; //per carrier, in RBs
+  std::string ccManager = "rr"; //rr, load or noop
   uint16_t numberOfUEs = 1;
-  uint16_t numberOfeNbs = 4;
+  uint16_t numberOfeNbs = 4; //number of sites, 0 fills the whole track
   double distance = 6000; //in meters
-  uint16_t outdoorUeMinSpeed = 25; //in m/s
-  uint16_t outdoorUeMaxSpeed = 25; //in m/s
+  std::string track = ""; //"x1,y1;x2,y2;..." polyline, straight line along x if empty
+  uint16_t sectorsPerSite = 1; //1 (omni), 2 (along the track) or 3
+  double siteOffset = 50; //distance of the masts from the track [m]
+  uint16_t x2NeighbourSites = 2; //X2 to sites this many sites away in each direction
+  double ueStartDistance = 100; //in meters along the track
+  double ueSpacing = 2; //distance between UEs in the train [m]
+  double trainSpeed = 25; //in m/s
+  std::string speedProfile = ""; //"d1:v1,d2:v2,..." [m:m/s], overrides trainSpeed
   bool useV6 = false; //IPv6 disabled by default
+  std::string streamRate = "2Mbps"; //downlink stream towards each UE
+  uint32_t qci = 0; //QCI of the stream bearer, 0 picks the one for UDP streaming
+  std::string bearers = ""; //extra dedicated bearers, "qci:port,qci:firstPort-lastPort,..."
+  double pingPongWindow = 1.0; //in seconds
+  std::string handoverAlgorithm = "A2A4"; //A2A4 (RSRQ) or A3 (RSRP)
+  uint16_t servingCellThreshold = 30; //A2A4, RSRQ range 0-34
+  uint16_t neighbourCellOffset = 1; //A2A4, RSRQ range 0-34
+  double hysteresis = 3.0; //A3, in dB
+  uint16_t timeToTrigger = 256; //A3, in ms
+  std::string sweepFile = "HandoverSweepUDPTrainJourney.csv"; //one summary line appended per run
+  std::string scheduler = "pf"; //LTE MAC scheduler, see LteSchedulerType
+  double animInterval = 1.0; //NetAnim position/counter sampling [s], 0 disables NetAnim
+  double linkWindow = 0.1; //per-UE link quality record interval [s], 0 disables
 
   /*
   
@@ -69,12 +109,34 @@ int main (int argc, char *argv[])
   CommandLine cmd;
   cmd.AddValue ("simTime", "Total duration of the simulation", simTime); // --simTime=*time*
   cmd.AddValue ("useCa", "Whether to use carrier aggregation.", useCa); // --useCa=true
+  cmd.AddValue ("numCcs", "Number of component carriers with carrier aggregation", numCcs);
+  cmd.AddValue ("ccBandwidth", "RBs of each component carrier: 6, 15, 25, 50, 75 or 100", ccBandwidth);
+  cmd.AddValue ("ccManager", "Carrier manager: rr (equal split), load (split by free PRBs) or noop (primary carrier only)", ccManager);
   cmd.AddValue ("numberOfUEs", "Number of UE nodes", numberOfUEs);
-  cmd.AddValue ("numberOfeNbs", "Number of eNb nodes", numberOfeNbs);
-  cmd.AddValue ("distance", "Distance between eNBs [m]", distance);
-  cmd.AddValue ("outdoorUeMinSpeed", "Min speed for UE to travel at [m/s]", outdoorUeMinSpeed);
-  cmd.AddValue ("outdoorUeMaxSpeed", "Max speed for UE to travel at [m/s]", outdoorUeMaxSpeed);
+  cmd.AddValue ("numberOfeNbs", "Number of eNb sites, 0 to fill the track", numberOfeNbs);
+  cmd.AddValue ("distance", "Distance between eNB sites along the track [m]", distance);
+  cmd.AddValue ("track", "Rail track polyline as x1,y1;x2,y2;... [m]", track);
+  cmd.AddValue ("sectorsPerSite", "Sectors per site (1, 2 or 3)", sectorsPerSite);
+  cmd.AddValue ("siteOffset", "Distance of the sites from the track [m]", siteOffset);
+  cmd.AddValue ("x2NeighbourSites", "Connect X2 to sites up to this many sites away", x2NeighbourSites);
+  cmd.AddValue ("ueStartDistance", "Where the train starts along the track [m]", ueStartDistance);
+  cmd.AddValue ("ueSpacing", "Spacing of the UEs inside the train [m]", ueSpacing);
+  cmd.AddValue ("trainSpeed", "Constant train speed [m/s]", trainSpeed);
+  cmd.AddValue ("speedProfile", "Speed profile as distance:speed,... [m:m/s]", speedProfile);
   cmd.AddValue ("useV6", "Use IPv6 addresses", useV6);
+  cmd.AddValue ("streamRate", "Data rate of the stream sent to each UE", streamRate);
+  cmd.AddValue ("qci", "QCI of the stream bearer, 0 picks the one for the traffic type", qci);
+  cmd.AddValue ("bearers", "Extra dedicated bearers as qci:port or qci:firstPort-lastPort, comma separated", bearers);
+  cmd.AddValue ("pingPongWindow", "Handover back to the previous cell within this time counts as ping-pong [s]", pingPongWindow);
+  cmd.AddValue ("handoverAlgorithm", "Handover algorithm: A2A4 (RSRQ) or A3 (RSRP)", handoverAlgorithm);
+  cmd.AddValue ("servingCellThreshold", "A2A4 serving cell RSRQ threshold", servingCellThreshold);
+  cmd.AddValue ("neighbourCellOffset", "A2A4 neighbour cell RSRQ offset", neighbourCellOffset);
+  cmd.AddValue ("hysteresis", "A3 hysteresis [dB]", hysteresis);
+  cmd.AddValue ("timeToTrigger", "A3 time to trigger [ms]", timeToTrigger);
+  cmd.AddValue ("sweepFile", "CSV file the run summary is appended to", sweepFile);
+  cmd.AddValue ("scheduler", "LTE MAC scheduler: pf, rr, tdmt, fdmt, tta, tdbet, fdbet, tdtbfq, fdtbfq, pss or cqa", scheduler);
+  cmd.AddValue ("animInterval", "NetAnim sampling interval [s], 0 disables the animation", animInterval);
+  cmd.AddValue ("linkWindow", "Interval of the per-UE SINR/CQI/MCS/PRB records [s], 0 disables them", linkWindow);
   cmd.Parse (argc, argv);
 
   //Other default inputs can be gathered from a pre-existing text file and loaded into a future simulation.
@@ -96,87 +158,111 @@ int main (int argc, char *argv[])
 
   //If user carrier aggregation is set to true via the command line...
     //enable carrier aggregation
-    //set number of component carriers to 2
-    //split traffic equally among carriers
+    //with numCcs carriers of ccBandwidth RBs
+    //split traffic among carriers by ccManager
   if (useCa)
    {
-     Config::SetDefault ("ns3::LteHelper::UseCa", BooleanValue (useCa));
-     Config::SetDefault ("ns3::LteHelper::NumberOfComponentCarriers", UintegerValue (2));
-     Config::SetDefault ("ns3::LteHelper::EnbComponentCarrierManager", StringValue ("ns3::RrComponentCarrierManager"));
+     ConfigureLteCa (numCcs, ccBandwidth, ccManager);
    }
 
   //Initialising the ltehelper function
   Ptr<LteHelper> lteHelper = CreateObject<LteHelper> ();
+  //Handover and X2 forwarding need the EPC, the server sits behind the PGW
+  Ptr<PointToPointEpcHelper> epcHelper = CreateObject<PointToPointEpcHelper> ();
+  lteHelper->SetEpcHelper (epcHelper);
   
   //EnB Handover
-  //Setting handover type to RSRQ
-  lteHelper->SetHandoverAlgorithmType ("ns3::A2A4RsrqHandoverAlgorithm");
-  
-  //If the RSRQ (power value) of the serving cell is worse than this threshold, neighbour cells are consider for handover
-  lteHelper->SetHandoverAlgorithmAttribute ("ServingCellThreshold",
-                                            UintegerValue (30));
-  //Minimum offset between the serving and the best neighbour cell to trigger the handover. 
-  lteHelper->SetHandoverAlgorithmAttribute ("NeighbourCellOffset",
-                                            UintegerValue (1));
+  if (handoverAlgorithm == "A2A4")
+    {
+      //Setting handover type to RSRQ
+      lteHelper->SetHandoverAlgorithmType ("ns3::A2A4RsrqHandoverAlgorithm");
+  
+      //If the RSRQ (power value) of the serving cell is worse than this threshold, neighbour cells are consider for handover
+      lteHelper->SetHandoverAlgorithmAttribute ("ServingCellThreshold",
+                                                UintegerValue (servingCellThreshold));
+      //Minimum offset between the serving and the best neighbour cell to trigger the handover. 
+      lteHelper->SetHandoverAlgorithmAttribute ("NeighbourCellOffset",
+                                                UintegerValue (neighbourCellOffset));
+    }
+  else if (handoverAlgorithm == "A3")
+    {
+      //Setting handover type to RSRP (strongest cell)
+      lteHelper->SetHandoverAlgorithmType ("ns3::A3RsrpHandoverAlgorithm");
+
+      //How much stronger the neighbour must be than the serving cell
+      lteHelper->SetHandoverAlgorithmAttribute ("Hysteresis",
+                                                DoubleValue (hysteresis));
+      //How long the neighbour must stay stronger before the handover is triggered
+      lteHelper->SetHandoverAlgorithmAttribute ("TimeToTrigger",
+                                                TimeValue (MilliSeconds (timeToTrigger)));
+    }
+  else
+    {
+      NS_FATAL_ERROR ("Unknown handoverAlgorithm " << handoverAlgorithm << ", use A2A4 or A3");
+    }
 
   // Uncomment to enable logging
 //  lteHelper->EnableLogComponents ();
 
+  //Rail corridor, by default a straight track with room for every site
+  std::vector<Vector> trackPoints;
+  if (track.empty ())
+    {
+      trackPoints.push_back (Vector (0.0, 0.0, 0.0));
+      trackPoints.push_back (Vector ((numberOfeNbs + 1) * distance, 0.0, 0.0));
+    }
+  else
+    {
+      trackPoints = RailCorridor::ParseTrack (track);
+    }
+  RailCorridor corridor (trackPoints);
+  if (numberOfeNbs == 0)
+    {
+      numberOfeNbs = corridor.GetNumSites (distance, distance);
+    }
+
   // Create Nodes: eNodeB and UE
   NodeContainer enbNodes;
   NodeContainer ueNodes;
   NodeContainer serverNode;
-  enbNodes.Create (numberOfeNbs);
+  enbNodes.Create (numberOfeNbs * sectorsPerSite);
   ueNodes.Create (numberOfUEs);
   serverNode.Create(1);
 
-  // Install Mobility Model
-  MobilityHelper mobility;
-  //set non moving enb nodes  
-  Ptr<ListPositionAllocator> enbPositionAlloc = CreateObject<ListPositionAllocator> ();
-  	  //x, y, z coords
-	  enbPositionAlloc->Add (Vector (distance, 0.0, 0.0));			// eNB1
-	  enbPositionAlloc->Add (Vector (distance*2,  0.0, 0.0));		// eNB2
-	  enbPositionAlloc->Add (Vector (distance*3, 0.0, 0.0));		// eNB3
-  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
-  mobility.SetPositionAllocator (enbPositionAlloc);
-  mobility.Install (enbNodes);
+  // Default scheduler is PF (proportionally fair), --scheduler=rr for RR (round robin) etc.
+  lteHelper->SetSchedulerType (LteSchedulerType (scheduler));
+
+  //set non moving enb nodes along the track, first site one inter-site distance in
+  NetDeviceContainer enbDevs;
+  enbDevs = corridor.InstallSites (lteHelper, enbNodes, sectorsPerSite, distance, distance, siteOffset, 30.0);
   BuildingsHelper::Install (enbNodes);
+  SchedulerStats schedulerStats (scheduler);
+  schedulerStats.Install (enbDevs, Seconds (0));
+  CarrierStats carrierStats;
+  if (useCa)
+    {
+      carrierStats.InstallLte (enbDevs, Seconds (0));
+    }
   
-  //Set UE nodes movement - FAST MOBILITY CAUSES FAILURES 
-  Ptr<ListPositionAllocator> uePositionAlloc = CreateObject<ListPositionAllocator> ();
-  	  //x, y, z coords
-	  uePositionAlloc->Add (Vector (100, 0.0, 0.0));		// ue1
-  mobility.SetMobilityModel ("ns3::SteadyStateRandomWaypointMobilityModel");
-  Config::SetDefault ("ns3::SteadyStateRandomWaypointMobilityModel::MaxSpeed", DoubleValue (outdoorUeMaxSpeed));
-  Config::SetDefault ("ns3::SteadyStateRandomWaypointMobilityModel::MinSpeed", DoubleValue (outdoorUeMinSpeed));
-  mobility.SetPositionAllocator (uePositionAlloc);
-  mobility.Install (ueNodes);
+  //Set UE nodes movement along the track
+  std::vector<RailCorridor::SpeedStep> profile;
+  if (speedProfile.empty ())
+    {
+      NS_ABORT_MSG_IF (trainSpeed <= 0, "trainSpeed must be > 0");
+      RailCorridor::SpeedStep cruise = {0.0, trainSpeed};
+      profile.push_back (cruise);
+    }
+  else
+    {
+      profile = RailCorridor::ParseSpeedProfile (speedProfile);
+    }
+  corridor.InstallTrain (ueNodes, profile, ueStartDistance, ueSpacing, Seconds (0));
   BuildingsHelper::Install (ueNodes);
   
-  // Create Devices and install them in the Nodes (eNB and UE)
-  NetDeviceContainer enbDevs;
+  // Create Devices and install them in the Nodes (UE)
   NetDeviceContainer ueDevs;
-  // Default scheduler is PF (proportionally fair), uncomment to use RR (round robin)
-  //lteHelper->SetSchedulerType ("ns3::RrFfMacScheduler");
-
-  enbDevs = lteHelper->InstallEnbDevice (enbNodes);
   ueDevs = lteHelper->InstallUeDevice (ueNodes);
 
-  // Attach a UE to an eNB
-  lteHelper->AttachToClosestEnb (ueDevs, enbDevs);
-
-  //Whenever a user equipment is being provided with any service,
-  //the service has to be associated with a Radio Bearer specifying
-  //the configuration for Layer-2 and Physical Layer in order to have
-  //its QoS clearly defined.
-
-  // Activate a data radio bearer
-  enum EpsBearer::Qci q = EpsBearer::GBR_CONV_VOICE;
-  EpsBearer bearer (q);
-  lteHelper->ActivateDataRadioBearer (ueDevs, bearer);
-  lteHelper->EnableTraces ();
-  
   /*
   
   
@@ -185,34 +271,36 @@ int main (int argc, char *argv[])
   
   */
   
-  //Technology for server and ue to communicate
+  //Technology for server and pgw to communicate
   PointToPointHelper pointToPoint;
   pointToPoint.SetDeviceAttribute ("DataRate", StringValue ("10000Mbps"));
   pointToPoint.SetChannelAttribute ("Delay", StringValue ("10ms"));
-  //Install technology on nodes
-  NetDeviceContainer devices;
-  devices = pointToPoint.Install (ueNodes);
   
-  //Use the internet stack helper and install on the ue nodes
+  //Use the internet stack helper and install on the server and ue nodes
   InternetStackHelper internet;
+  internet.Install (serverNode);
   internet.Install (ueNodes);
   
-  //Assigning IP addresses
+  //Assigning IP addresses, the server gets one on the PGW link and the UEs from the EPC
   NS_LOG_INFO ("Assign IP Addresses.");
-  if (useV6 == false)
-    {
-      Ipv4AddressHelper ipv4;
-      ipv4.SetBase ("10.1.1.0", "255.255.255.0");
-      Ipv4InterfaceContainer i = ipv4.Assign (enbDevs, ueDevs);
-      serverAddress = Address (i.GetAddress (1));
-    }
-  else
-    {
-      Ipv6AddressHelper ipv6;
-      ipv6.SetBase ("2001:0000:f00d:cafe::", Ipv6Prefix (64));
-      Ipv6InterfaceContainer i6 = ipv6.Assign (enbDevs, ueDevs);
-      serverAddress = Address(i6.GetAddress (1,1));
-    }
+  ConnectRemoteHost (epcHelper, serverNode.Get (0), pointToPoint, useV6);
+  std::vector<Address> ueAddresses = AssignUeAddresses (epcHelper, ueNodes, ueDevs, useV6);
+
+  // Attach a UE to an eNB once it has an address, the EPC sets up the default bearer
+  lteHelper->AttachToClosestEnb (ueDevs, enbDevs);
+
+  // Connect neighbouring eNBs with X2 so handovers can forward buffered data
+  corridor.AddX2Interfaces (lteHelper, enbNodes, sectorsPerSite, x2NeighbourSites);
+  
+  //Whenever a user equipment is being provided with any service,
+  //the service has to be associated with a Radio Bearer specifying
+  //the configuration for Layer-2 and Physical Layer in order to have
+  //its QoS clearly defined.
+
+  // Activate a dedicated bearer with the QCI of the traffic type, plus any extra ones
+  uint16_t port = 50000;
+  ActivateBearers (lteHelper, ueDevs, TrafficBearers ("udp", qci, port, bearers));
+  lteHelper->EnableTraces ();
   
   /*
   
@@ -222,25 +310,26 @@ int main (int argc, char *argv[])
   
   */
   
-  // Create a UDP Server on the receiver
-  uint16_t port = 50000;
-  UdpServerHelper server (port)
-  Address sinkLocalAddress(InetSocketAddress (Ipv4Address::GetAny (), port));
-  PacketSinkHelper sinkHelper ("ns3::UdpSocketFactory", sinkLocalAddress);
-  ApplicationContainer sinkApp = sinkHelper.Install (serverNode);
+  // Create a UDP packet sink on every ue
+  PacketSinkHelper sinkHelper ("ns3::UdpSocketFactory", AnySocketAddress (useV6, port));
+  ApplicationContainer sinkApp = sinkHelper.Install (ueNodes);
   sinkApp.Start (Seconds (1.0));
-  sinkApp.Stop (Seconds (simTime));
-  
-  // Create the OnOff applications to send data to the UDP receiver
-  OnOffHelper clientHelper ("ns3::UdpSocketFactory", Address ());
-  clientHelper.SetAttribute ("Remote", remoteAddress);
-  echoClient.SetAttribute ("MaxPackets", UintegerValue (1));
-  echoClient.SetAttribute ("Interval", TimeValue (Seconds (1.0)));
-  echoClient.SetAttribute ("PacketSize", UintegerValue (1024));
-  //Install the client apps on the ue nodes and start/stop themn
-  ApplicationContainer clientApps = (clientHelper.Install (ueNodes);
+  sinkApp.Stop (simTime);
+  
+  // Create the OnOff applications on the server to stream to each ue
+  ApplicationContainer clientApps;
+  for (uint32_t u = 0; u < ueNodes.GetN (); ++u)
+    {
+      OnOffHelper clientHelper ("ns3::UdpSocketFactory", SocketAddress (ueAddresses[u], port));
+      clientHelper.SetAttribute ("OnTime", StringValue ("ns3::ConstantRandomVariable[Constant=1]"));
+      clientHelper.SetAttribute ("OffTime", StringValue ("ns3::ConstantRandomVariable[Constant=0]"));
+      clientHelper.SetAttribute ("DataRate", DataRateValue (DataRate (streamRate)));
+      clientHelper.SetAttribute ("PacketSize", UintegerValue (1024));
+      clientApps.Add (clientHelper.Install (serverNode.Get (0)));
+    }
+  //Start/stop the client apps on the server
   clientApps.Start (Seconds (2.0));
-  clientApps.Stop (Seconds (simTime));
+  clientApps.Stop (simTime);
   
   /*
   
@@ -250,8 +339,32 @@ int main (int argc, char *argv[])
   
   */
   
-  //Create xml file with given name
-  AnimationInterface anim ("streamingOnTrain.xml");
+  //Create xml file with given name, positions and packet counters are sampled every animInterval
+  AnimRecorder *anim = 0;
+  if (animInterval > 0)
+    {
+      anim = new AnimRecorder ("streamingOnTrain.xml", Seconds (animInterval));
+    }
+
+  //Handover start/end, interruption, X2 forwarding, ping-pong and RLF per UE
+  HandoverStats handoverStats ("HandoverEventsUDPTrainJourney.csv", Seconds (pingPongWindow));
+  handoverStats.Install (ueNodes, ueDevs, enbNodes, enbDevs);
+  //Per-UE SINR, CQI, MCS and PRBs every linkWindow
+  LinkQualityRecorder linkQuality ("LinkQualityUDPTrainJourney.csv", Seconds (linkWindow));
+  if (linkWindow > 0)
+    {
+      linkQuality.InstallLte (enbDevs);
+    }
+
+  // Flow monitor on the ue and server nodes
+  Ptr<FlowMonitor> flowMonitor;
+  FlowMonitorHelper flowHelper;
+  NodeContainer endpoints (ueNodes, serverNode);
+  flowMonitor = flowHelper.Install (endpoints);
+  //Specifying histogram bin widths for delay, jitter and packet size
+  flowMonitor->SetAttribute("DelayBinWidth", DoubleValue(0.001));
+  flowMonitor->SetAttribute("JitterBinWidth", DoubleValue(0.001));
+  flowMonitor->SetAttribute("PacketSizeBinWidth", DoubleValue(20));
   
   /*
   
@@ -262,11 +375,46 @@ int main (int argc, char *argv[])
   */
 
   Simulator::Stop (simTime);
+  schedulerStats.StartClock ();
   Simulator::Run ();
+  schedulerStats.StopClock ();
+
+  //Print goodput, delay percentiles, jitter and loss for each IPv4/IPv6 flow (SI units)
+  flowMonitor->CheckForLostPackets ();
+  PrintFlowMetrics (flowMonitor, flowHelper);
+  schedulerStats.Print ();
+  if (useCa)
+    {
+      carrierStats.Print ();
+    }
+  flowMonitor->SerializeToXmlFile ("FlowMonitorUDPTrainJourney.xml", true, true); //histograms and probes enabled
+
+  handoverStats.Finish ();
+  linkQuality.Finish ();
+
+  //Append handover count vs interruption vs goodput for this parameter set
+  //A file written with other columns is not appended to. The speed is the
+  //mean over the ride, so a speed profile is summarised too
+  std::string sweepHeader = "algorithm,meanSpeed_mps,servingCellThreshold,neighbourCellOffset,hysteresis_db,ttt_ms,"
+                            "handovers,meanInterruptMs,goodputMbps,"
+                            "scheduler,ues,scheduledMbps,jainIndex,wallUsPerTti";
+  std::ofstream sweep;
+  OpenSweepFile (sweep, sweepFile, sweepHeader);
+  sweep << handoverAlgorithm << "," << corridor.GetMeanSpeed (profile, ueStartDistance, simTime) << ","
+        << servingCellThreshold << "," << neighbourCellOffset << ","
+        << hysteresis << "," << timeToTrigger << ","
+        << handoverStats.GetHandoverCount () << ","
+        << handoverStats.GetMeanInterruptionMs () << ","
+        << TotalGoodputMbps (flowMonitor) << ","
+        << scheduler << "," << numberOfUEs << ","
+        << schedulerStats.GetScheduledMbps () << ","
+        << schedulerStats.GetJainIndex () << ","
+        << schedulerStats.GetWallUsPerTti () << "\n";
 
   // GtkConfigStore config;
   // config.ConfigureAttributes ();
 
+  delete anim;
   Simulator::Destroy ();
   return 0;
 }
@@ -0,0 +1,169 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//Decimated NetAnim output for long runs.
+//
+//A plain AnimationInterface logs every packet and keeps per-packet state
+//until it is drawn, which makes the XML of a 2 hour journey unusable. This
+//recorder keeps the AnimationInterface for node positions, polled at a fixed
+//interval, and replaces packet animation with per-node Tx/Rx packet and byte
+//counters that are written once per interval. Memory is one counter set per
+//node and the XML is streamed to disk as the simulation runs.
+
+#ifndef ANIM_RECORDER_H
+#define ANIM_RECORDER_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/netanim-module.h"
+
+#include <cstdlib>
+#include <vector>
+
+namespace ns3 {
+
+class AnimRecorder
+{
+public:
+  AnimRecorder (std::string filename, Time interval)
+    : m_interval (interval)
+  {
+    m_anim = new AnimationInterface (filename);
+    m_anim->SetMobilityPollInterval (interval);
+    m_anim->SkipPacketTracing ();
+    m_anim->EnablePacketMetadata (false);
+
+    m_txPackets = m_anim->AddNodeCounter ("Tx packets", AnimationInterface::UINT32_COUNTER);
+    m_rxPackets = m_anim->AddNodeCounter ("Rx packets", AnimationInterface::UINT32_COUNTER);
+    m_rxBytes = m_anim->AddNodeCounter ("Rx bytes", AnimationInterface::DOUBLE_COUNTER);
+
+    Config::Connect ("/NodeList/*/$ns3::Ipv4L3Protocol/Tx", MakeCallback (&AnimRecorder::TxV4, this));
+    Config::Connect ("/NodeList/*/$ns3::Ipv4L3Protocol/Rx", MakeCallback (&AnimRecorder::RxV4, this));
+    Config::Connect ("/NodeList/*/$ns3::Ipv6L3Protocol/Tx", MakeCallback (&AnimRecorder::TxV6, this));
+    Config::Connect ("/NodeList/*/$ns3::Ipv6L3Protocol/Rx", MakeCallback (&AnimRecorder::RxV6, this));
+
+    m_counters.resize (NodeList::GetNNodes ());
+    Simulator::Schedule (m_interval, &AnimRecorder::Flush, this);
+  }
+
+  ~AnimRecorder ()
+  {
+    delete m_anim;
+  }
+
+  AnimationInterface *
+  GetAnimationInterface ()
+  {
+    return m_anim;
+  }
+
+private:
+  //Not copyable, the AnimationInterface is owned
+  AnimRecorder (const AnimRecorder &);
+  AnimRecorder &operator= (const AnimRecorder &);
+
+  struct NodeCounters
+  {
+    NodeCounters ()
+      : txPackets (0), rxPackets (0), rxBytes (0), shown (false)
+    {
+    }
+    uint32_t txPackets;
+    uint32_t rxPackets;
+    double rxBytes;
+    bool shown; //non-zero counters were written in the last interval
+  };
+
+  static uint32_t
+  NodeIdFromContext (const std::string &context)
+  {
+    //"/NodeList/<id>/..."
+    return std::atoi (context.substr (10, context.find ('/', 10) - 10).c_str ());
+  }
+
+  NodeCounters &
+  CountersFor (const std::string &context)
+  {
+    uint32_t id = NodeIdFromContext (context);
+    if (id >= m_counters.size ())
+      {
+        m_counters.resize (id + 1);
+      }
+    return m_counters[id];
+  }
+
+  void
+  TxV4 (std::string context, Ptr<const Packet> p, Ptr<Ipv4> ipv4, uint32_t interface)
+  {
+    CountersFor (context).txPackets++;
+  }
+
+  void
+  RxV4 (std::string context, Ptr<const Packet> p, Ptr<Ipv4> ipv4, uint32_t interface)
+  {
+    NodeCounters &c = CountersFor (context);
+    c.rxPackets++;
+    c.rxBytes += p->GetSize ();
+  }
+
+  void
+  TxV6 (std::string context, Ptr<const Packet> p, Ptr<Ipv6> ipv6, uint32_t interface)
+  {
+    CountersFor (context).txPackets++;
+  }
+
+  void
+  RxV6 (std::string context, Ptr<const Packet> p, Ptr<Ipv6> ipv6, uint32_t interface)
+  {
+    NodeCounters &c = CountersFor (context);
+    c.rxPackets++;
+    c.rxBytes += p->GetSize ();
+  }
+
+  //Write the counters of the nodes that saw traffic (or just went idle)
+  //and start a new interval
+  void
+  Flush ()
+  {
+    for (uint32_t id = 0; id < m_counters.size (); ++id)
+      {
+        NodeCounters &c = m_counters[id];
+        bool active = c.txPackets > 0 || c.rxPackets > 0;
+        if (!active && !c.shown)
+          {
+            continue;
+          }
+        m_anim->UpdateNodeCounter (m_txPackets, id, c.txPackets);
+        m_anim->UpdateNodeCounter (m_rxPackets, id, c.rxPackets);
+        m_anim->UpdateNodeCounter (m_rxBytes, id, c.rxBytes);
+        c = NodeCounters ();
+        c.shown = active;
+      }
+    Simulator::Schedule (m_interval, &AnimRecorder::Flush, this);
+  }
+
+  AnimationInterface *m_anim;
+  Time m_interval;
+  uint32_t m_txPackets;
+  uint32_t m_rxPackets;
+  uint32_t m_rxBytes;
+  std::vector<NodeCounters> m_counters;
+};
+
+} // namespace ns3
+
+#endif /* ANIM_RECORDER_H */
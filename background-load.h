@@ -0,0 +1,220 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//Background UEs that load the cell so the measured UE has to compete for
+//the scheduler.
+//
+//The background UEs are placed at random around the eNB and get downlink
+//UDP from their own remote host, which is not given to the flow monitor,
+//so they add no per flow tracking. Traffic is one of
+//  fullbuffer  every UE always has data, the cell runs at its limit
+//  cbr         constant rate, sized so all UEs offer load * cell rate
+//  poisson     exponential on/off bursts with the same mean rate as cbr
+//The cell rate is the peak downlink rate the scenario passes in, the top
+//MCS on every resource (LtePeakDlMbps, MmWavePeakDlMbps). The load is what
+//the server offers, not what the cell achieves: UEs on a worse channel get
+//a lower MCS, so the same load takes more of the cell. On LTE the PRBs used
+//by the scheduler can be counted to check the load reached.
+
+#ifndef BACKGROUND_LOAD_H
+#define BACKGROUND_LOAD_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/lte-module.h"
+#include <ns3/buildings-helper.h>
+
+#include "epc-topology.h"
+#include "scheduler-stats.h"
+
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+namespace ns3 {
+
+class BackgroundLoad
+{
+public:
+  //Background UEs are sent to ports from this one up
+  static const uint16_t BASE_PORT = 40000;
+
+  BackgroundLoad (uint32_t numUes, double load, std::string traffic, double cellMbps)
+    : m_numUes (numUes),
+      m_load (load),
+      m_traffic (traffic),
+      m_cellMbps (cellMbps),
+      m_maxPrbs (0),
+      m_prbs (0),
+      m_prbsPerTti (0)
+  {
+    NS_ABORT_MSG_IF (traffic != "fullbuffer" && traffic != "cbr" && traffic != "poisson",
+                     "Unknown background traffic " << traffic << ", use fullbuffer, cbr or poisson");
+    NS_ABORT_MSG_IF (load <= 0 || load > 1, "Background load must be in (0, 1]");
+  }
+
+  //Create the background UEs at random within radius metres of the eNB
+  NodeContainer
+  CreateUes (Ptr<Node> enb, double radius)
+  {
+    m_ues.Create (m_numUes);
+    if (m_numUes == 0)
+      {
+        return m_ues;
+      }
+    Vector centre = enb->GetObject<MobilityModel> ()->GetPosition ();
+    std::ostringstream rho;
+    rho << "ns3::UniformRandomVariable[Min=0|Max=" << radius << "]";
+    MobilityHelper mobility;
+    mobility.SetPositionAllocator ("ns3::RandomDiscPositionAllocator",
+                                   "X", DoubleValue (centre.x),
+                                   "Y", DoubleValue (centre.y),
+                                   "Rho", StringValue (rho.str ()));
+    mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+    mobility.Install (m_ues);
+    BuildingsHelper::Install (m_ues);
+    return m_ues;
+  }
+
+  //Give the UEs their addresses, IPv6 with useV6 like the measured UE,
+  //connect their own remote host to the PGW with a link like p2p but fast
+  //enough for the load and start the downlink traffic. Call before the UEs
+  //attach.
+  void
+  Install (Ptr<EpcHelper> epcHelper, NetDeviceContainer ueDevs, PointToPointHelper &p2p, bool useV6, Time start)
+  {
+    if (m_numUes == 0)
+      {
+        return;
+      }
+    m_start = start;
+    Ptr<Node> server = CreateObject<Node> ();
+    InternetStackHelper internet;
+    internet.Install (server);
+    internet.Install (m_ues);
+    double ueMbps = m_cellMbps * (m_traffic == "fullbuffer" ? 1.0 : m_load / m_numUes);
+    //the server link carries twice the peak offered, so it is never the
+    //bottleneck (a fullbuffer UE alone offers the whole cell rate)
+    double peakMbps = ueMbps * m_numUes * (m_traffic == "poisson" ? 2.0 : 1.0);
+    PointToPointHelper link = p2p;
+    link.SetDeviceAttribute ("DataRate", DataRateValue (DataRate (2e6 * peakMbps)));
+    ConnectRemoteHost (epcHelper, server, link, useV6);
+    std::vector<Address> ueAddresses = AssignUeAddresses (epcHelper, m_ues, ueDevs, useV6);
+
+    for (uint32_t u = 0; u < m_numUes; ++u)
+      {
+        uint16_t port = BASE_PORT + u;
+        PacketSinkHelper sink ("ns3::UdpSocketFactory", AnySocketAddress (useV6, port));
+        sink.Install (m_ues.Get (u));
+
+        OnOffHelper source ("ns3::UdpSocketFactory", SocketAddress (ueAddresses[u], port));
+        source.SetAttribute ("PacketSize", UintegerValue (1400));
+        if (m_traffic == "poisson")
+          {
+            //on half the time on average, so send at twice the mean rate
+            source.SetAttribute ("OnTime", StringValue ("ns3::ExponentialRandomVariable[Mean=0.05]"));
+            source.SetAttribute ("OffTime", StringValue ("ns3::ExponentialRandomVariable[Mean=0.05]"));
+            source.SetAttribute ("DataRate", DataRateValue (DataRate (2e6 * ueMbps)));
+          }
+        else
+          {
+            source.SetAttribute ("OnTime", StringValue ("ns3::ConstantRandomVariable[Constant=1]"));
+            source.SetAttribute ("OffTime", StringValue ("ns3::ConstantRandomVariable[Constant=0]"));
+            source.SetAttribute ("DataRate", DataRateValue (DataRate (1e6 * ueMbps)));
+          }
+        ApplicationContainer apps = source.Install (server);
+        apps.Start (start);
+      }
+  }
+
+  //Count the downlink PRBs the LTE schedulers allocate to every UE of the
+  //cells, from the TB size and MCS of each allocation
+  void
+  MonitorLtePrbs (NetDeviceContainer enbDevs)
+  {
+    if (m_numUes == 0)
+      {
+        return;
+      }
+    for (uint32_t e = 0; e < enbDevs.GetN (); ++e)
+      {
+        Ptr<LteEnbNetDevice> enb = enbDevs.Get (e)->GetObject<LteEnbNetDevice> ();
+        m_prbsPerTti += enb->GetDlBandwidth () * enb->GetCcMap ().size ();
+        m_maxPrbs = std::max<uint16_t> (m_maxPrbs, enb->GetDlBandwidth ());
+      }
+    m_amc = CreateObject<LteAmc> ();
+    Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/ComponentCarrierMap/*/LteEnbMac/DlScheduling",
+                                   MakeCallback (&BackgroundLoad::DlScheduling, this));
+  }
+
+  NodeContainer
+  GetUes () const
+  {
+    return m_ues;
+  }
+
+  void
+  Print (std::ostream &os = std::cout) const
+  {
+    if (m_numUes == 0)
+      {
+        return;
+      }
+    os << "Background load: " << m_numUes << " UEs, " << m_traffic << " traffic";
+    if (m_traffic != "fullbuffer")
+      {
+        os << ", offered " << m_load * m_cellMbps << " Mbps (" << 100 * m_load << " % of "
+           << m_cellMbps << " Mbps)";
+      }
+    os << "\n";
+    if (m_prbsPerTti > 0)
+      {
+        double ttis = (Simulator::Now () - m_start).GetMilliSeconds ();
+        os << "  DL PRB utilisation: " << (ttis > 0 ? 100.0 * m_prbs / (ttis * m_prbsPerTti) : 0) << " %\n";
+      }
+  }
+
+private:
+  void
+  DlScheduling (DlSchedulingCallbackInfo info)
+  {
+    if (Simulator::Now () < m_start || info.sizeTb1 == 0)
+      {
+        return;
+      }
+    m_prbs += DlPrbsFromTb (m_amc, info.mcsTb1, info.sizeTb1, m_maxPrbs);
+  }
+
+  uint32_t m_numUes;
+  double m_load;
+  std::string m_traffic;
+  double m_cellMbps;
+  NodeContainer m_ues;
+  Time m_start;
+  Ptr<LteAmc> m_amc;
+  uint16_t m_maxPrbs;
+  uint64_t m_prbs;
+  uint32_t m_prbsPerTti;
+};
+
+} // namespace ns3
+
+#endif /* BACKGROUND_LOAD_H */
@@ -0,0 +1,145 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//Dedicated EPS bearers with traffic flow templates.
+//
+//Each scenario puts its traffic on a dedicated bearer whose QCI matches
+//the traffic type, and more bearers can be added from the command line as
+//"qci:port,qci:firstPort-lastPort,...". A bearer carries the packets whose
+//port on the server or UE side is in its range, everything else stays on
+//the default bearer (QCI 9) set up by the EPC on attach.
+
+#ifndef BEARER_CONFIG_H
+#define BEARER_CONFIG_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/lte-module.h"
+
+#include <algorithm>
+#include <sstream>
+#include <vector>
+
+namespace ns3 {
+
+struct BearerSpec
+{
+  EpsBearer::Qci qci;
+  uint16_t portStart;
+  uint16_t portEnd;
+};
+
+//QCI used for each traffic type of the scenarios (TS 23.203 table 6.1.7)
+inline EpsBearer::Qci
+DefaultQci (std::string traffic)
+{
+  if (traffic == "voip")
+    {
+      return EpsBearer::GBR_CONV_VOICE;          //1, conversational voice
+    }
+  if (traffic == "udp")
+    {
+      return EpsBearer::NGBR_VOICE_VIDEO_GAMING; //7, real time streaming
+    }
+  if (traffic == "http")
+    {
+      return EpsBearer::NGBR_VIDEO_TCP_OPERATOR; //6, interactive TCP
+    }
+  if (traffic == "tcp")
+    {
+      return EpsBearer::NGBR_VIDEO_TCP_DEFAULT;  //9, bulk TCP
+    }
+  NS_FATAL_ERROR ("No QCI for traffic type " << traffic);
+  return EpsBearer::NGBR_VIDEO_TCP_DEFAULT;
+}
+
+inline EpsBearer::Qci
+QciFromNumber (uint32_t qci)
+{
+  NS_ABORT_MSG_IF (qci < 1 || qci > 9, "QCI " << qci << " is not supported, use 1 to 9");
+  return static_cast<EpsBearer::Qci> (qci);
+}
+
+//"qci:port,qci:firstPort-lastPort,..." as given on the command line
+inline std::vector<BearerSpec>
+ParseBearers (std::string text)
+{
+  std::vector<BearerSpec> bearers;
+  std::replace (text.begin (), text.end (), ',', ' ');
+  std::istringstream in (text);
+  std::string item;
+  while (in >> item)
+    {
+      uint32_t qci = 0, first = 0, last = 0;
+      char colon = 0, dash = '-';
+      std::istringstream p (item);
+      p >> qci >> colon >> first;
+      last = first;
+      if (!p.eof () && p.peek () == '-')
+        {
+          p >> dash >> last;
+        }
+      NS_ABORT_MSG_IF (p.fail () || colon != ':' || last < first || last > 65535,
+                       "Bad bearer " << item << ", expected qci:port or qci:firstPort-lastPort");
+      BearerSpec b = { QciFromNumber (qci), static_cast<uint16_t> (first), static_cast<uint16_t> (last) };
+      bearers.push_back (b);
+    }
+  return bearers;
+}
+
+//TFT matching the port range on either end, in both directions
+inline Ptr<EpcTft>
+PortRangeTft (uint16_t portStart, uint16_t portEnd)
+{
+  Ptr<EpcTft> tft = Create<EpcTft> ();
+  EpcTft::PacketFilter remote;
+  remote.remotePortStart = portStart;
+  remote.remotePortEnd = portEnd;
+  tft->Add (remote);
+  EpcTft::PacketFilter local;
+  local.localPortStart = portStart;
+  local.localPortEnd = portEnd;
+  tft->Add (local);
+  return tft;
+}
+
+//Activate one dedicated bearer per spec on every UE. HELPER is LteHelper
+//or MmWaveHelper, the UEs must already have their addresses.
+template <class HELPER>
+void
+ActivateBearers (Ptr<HELPER> helper, NetDeviceContainer ueDevs, const std::vector<BearerSpec> &bearers)
+{
+  for (uint32_t b = 0; b < bearers.size (); ++b)
+    {
+      EpsBearer bearer (bearers[b].qci);
+      helper->ActivateDedicatedEpsBearer (ueDevs, bearer, PortRangeTft (bearers[b].portStart, bearers[b].portEnd));
+    }
+}
+
+//Bearer of the scenario traffic followed by the extra bearers
+inline std::vector<BearerSpec>
+TrafficBearers (std::string traffic, uint32_t qci, uint16_t port, std::string extraBearers)
+{
+  BearerSpec main = { qci == 0 ? DefaultQci (traffic) : QciFromNumber (qci), port, port };
+  std::vector<BearerSpec> bearers (1, main);
+  std::vector<BearerSpec> extra = ParseBearers (extraBearers);
+  bearers.insert (bearers.end (), extra.begin (), extra.end ());
+  return bearers;
+}
+
+} // namespace ns3
+
+#endif /* BEARER_CONFIG_H */
@@ -0,0 +1,132 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//What the per radio bearer traces (latency-budget.h, rlc-queue-stats.h)
+//share: the key of a bearer and direction, the config paths of the UE RRC
+//and the time an SDU spent in RLC.
+//
+//RNTIs are only unique within a cell, so the key also holds the node of
+//the eNB serving the bearer. Traces at the eNB take it from their context,
+//traces at the UE from the cell its RRC is attached to.
+//
+//The LTE stack, which mmWave reuses above the MAC, reports at the
+//receiving end the delay since the SDU entered PDCP (PDCP RxPDU) and since
+//RLC handed the PDU to the MAC (RLC RxPDU). The PDU that completes an SDU
+//is received just before it, so the sojourn of the SDU in RLC is its PDCP
+//delay less the RLC delay of the last PDU.
+
+#ifndef BEARER_TRACE_H
+#define BEARER_TRACE_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/lte-module.h"
+#include "ns3/mmwave-enb-net-device.h"
+
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+//enbNode << 32 | uplink << 24 | lcid << 16 | rnti
+inline uint64_t
+BearerKey (uint32_t enbNode, bool uplink, uint16_t rnti, uint8_t lcid)
+{
+  return (static_cast<uint64_t> (enbNode) << 32) | (static_cast<uint64_t> (uplink) << 24)
+         | (static_cast<uint64_t> (lcid) << 16) | rnti;
+}
+
+inline uint32_t
+BearerEnbNode (uint64_t key)
+{
+  return key >> 32;
+}
+
+inline bool
+BearerUplink (uint64_t key)
+{
+  return (key >> 24) & 0x1;
+}
+
+inline uint16_t
+BearerRnti (uint64_t key)
+{
+  return key & 0xffff;
+}
+
+inline uint32_t
+BearerLcid (uint64_t key)
+{
+  return (key >> 16) & 0xff;
+}
+
+//Node of a "/NodeList/<id>/..." trace context
+inline uint32_t
+ContextNode (std::string context)
+{
+  return std::atoi (context.substr (10, context.find ('/', 10) - 10).c_str ());
+}
+
+//Node of every LTE and mmWave eNB device, by cell id
+inline std::map<uint16_t, uint32_t>
+EnbNodeByCell ()
+{
+  std::map<uint16_t, uint32_t> nodes;
+  for (NodeList::Iterator n = NodeList::Begin (); n != NodeList::End (); ++n)
+    {
+      for (uint32_t d = 0; d < (*n)->GetNDevices (); ++d)
+        {
+          Ptr<LteEnbNetDevice> lte = DynamicCast<LteEnbNetDevice> ((*n)->GetDevice (d));
+          Ptr<mmwave::MmWaveEnbNetDevice> mmw = DynamicCast<mmwave::MmWaveEnbNetDevice> ((*n)->GetDevice (d));
+          if (lte)
+            {
+              nodes[lte->GetCellId ()] = (*n)->GetId ();
+            }
+          else if (mmw)
+            {
+              nodes[mmw->GetCellId ()] = (*n)->GetId ();
+            }
+        }
+    }
+  return nodes;
+}
+
+//RRC of the UE devices of the given node ("*" for every node), the LTE
+//and mmWave UE devices name theirs differently
+inline std::vector<std::string>
+UeRrcPaths (std::string node)
+{
+  const char *names[] = { "LteUeRrc", "mmWaveUeRrc" };
+  std::vector<std::string> paths;
+  for (uint32_t n = 0; n < 2; ++n)
+    {
+      paths.push_back ("/NodeList/" + node + "/DeviceList/*/" + names[n]);
+    }
+  return paths;
+}
+
+//Sojourn in RLC [s] of the SDU received with this PDCP delay
+inline double
+RlcSojourn (uint64_t pdcpDelayNs, uint64_t lastRlcDelayNs)
+{
+  return pdcpDelayNs > lastRlcDelayNs ? (pdcpDelayNs - lastRlcDelayNs) * 1e-9 : 0.0;
+}
+
+} // namespace ns3
+
+#endif /* BEARER_TRACE_H */
@@ -0,0 +1,392 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//Urban grid of buildings around the eNB and the loss of entering them.
+//
+//The grid has blocks x blocks square buildings of blockSize metres,
+//separated by streets of streetWidth metres, centred so the eNB at the
+//origin stands on the middle crossroads, which takes an even number of
+//blocks. Every building has the given floors of
+//3 m and external walls of wallLoss dB.
+//
+//BuildingPenetrationLossModel adds the wall loss of the building each end
+//of a link is in, nothing when both are in the same one. It is chained
+//after the mmWave pathloss model and follows Friis as the LTE pathloss.
+//The building a node is in is cached with the time its current course
+//next crosses a wall, so the geometry is only looked at again on a
+//crossing or a course change, when the node's MobilityBuildingInfo is
+//also brought up to date for the buildings aware models.
+
+#ifndef BUILDING_GRID_H
+#define BUILDING_GRID_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/buildings-module.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/lte-helper.h"
+#include "ns3/mmwave-helper.h"
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <set>
+
+namespace ns3 {
+
+struct BuildingGrid
+{
+  uint32_t blocks;      //per side, 0 for open space
+  double blockSize;     //m
+  double streetWidth;   //m
+  uint32_t floors;
+  double wallLossDb;
+
+  //floors of 3 m
+  double
+  HeightM () const
+  {
+    return floors * 3.0;
+  }
+};
+
+inline BuildingGrid
+DefaultBuildingGrid ()
+{
+  BuildingGrid g = { 0, 50.0, 20.0, 3, 12.0 };
+  return g;
+}
+
+//Create the buildings of the grid, the eNB at the origin is on a street
+inline BuildingContainer
+CreateBuildingGrid (const BuildingGrid &g)
+{
+  BuildingContainer buildings;
+  NS_ABORT_MSG_IF (g.blocks > 0 && (g.blockSize <= 0 || g.streetWidth <= 0 || g.floors < 1),
+                   "A building grid needs blocks, streets and floors of positive size");
+  //an odd grid would put its middle block on the eNB
+  NS_ABORT_MSG_IF (g.blocks % 2 != 0, "A building grid needs an even number of blocks per side, not " << g.blocks);
+  double pitch = g.blockSize + g.streetWidth;
+  double first = -(g.blocks * pitch) / 2 + g.streetWidth / 2;
+  //the ns-3 wall type closest to the wall loss, for the buildings aware models
+  Building::ExtWallsType_t walls = g.wallLossDb < 5.5 ? Building::Wood
+    : g.wallLossDb < 9.5 ? Building::ConcreteWithWindows
+    : g.wallLossDb < 13.5 ? Building::StoneBlocks : Building::ConcreteWithoutWindows;
+  for (uint32_t i = 0; i < g.blocks; ++i)
+    {
+      for (uint32_t j = 0; j < g.blocks; ++j)
+        {
+          double x = first + i * pitch;
+          double y = first + j * pitch;
+          Ptr<Building> b = CreateObject<Building> ();
+          b->SetBoundaries (Box (x, x + g.blockSize, y, y + g.blockSize, 0.0, g.HeightM ()));
+          b->SetBuildingType (Building::Residential);
+          b->SetExtWallsType (walls);
+          b->SetNFloors (g.floors);
+          buildings.Add (b);
+        }
+    }
+  return buildings;
+}
+
+class BuildingPenetrationLossModel : public PropagationLossModel
+{
+public:
+  static TypeId
+  GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("ns3::BuildingPenetrationLossModel")
+      .SetParent<PropagationLossModel> ()
+      .SetGroupName ("Buildings")
+      .AddConstructor<BuildingPenetrationLossModel> ()
+      .AddAttribute ("WallLoss", "Loss of the external walls of a building [dB]",
+                     DoubleValue (12.0),
+                     MakeDoubleAccessor (&BuildingPenetrationLossModel::m_wallLossDb),
+                     MakeDoubleChecker<double> (0.0));
+    return tid;
+  }
+
+  //Geometry lookups so far, against the links they served
+  uint64_t
+  GetRefreshes () const
+  {
+    return m_refreshes;
+  }
+
+  uint64_t
+  GetQueries () const
+  {
+    return m_queries;
+  }
+
+  BuildingPenetrationLossModel ()
+    : m_refreshes (0),
+      m_queries (0)
+  {
+  }
+
+private:
+  struct NodeState
+  {
+    uint32_t building; //BuildingList index, NONE outdoors
+    Time validUntil;   //next wall crossing on the current course
+    uint32_t moves;
+  };
+
+  static const uint32_t NONE = 0xffffffff;
+
+  virtual double
+  DoCalcRxPower (double txPowerDbm, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const
+  {
+    m_queries++;
+    uint32_t inA = Lookup (a);
+    uint32_t inB = Lookup (b);
+    if (inA == inB)
+      {
+        //both outdoors or in the same building
+        return txPowerDbm;
+      }
+    return txPowerDbm - m_wallLossDb * ((inA != NONE) + (inB != NONE));
+  }
+
+  virtual int64_t
+  DoAssignStreams (int64_t stream)
+  {
+    return 0;
+  }
+
+  //Building the node is in, from the cache while it is still on the
+  //course it had and has not reached a wall
+  uint32_t
+  Lookup (Ptr<MobilityModel> mobility) const
+  {
+    Ptr<Node> node = mobility->GetObject<Node> ();
+    NS_ASSERT_MSG (node != 0, "Building penetration needs the mobility models aggregated to nodes");
+    uint32_t id = node->GetId ();
+    if (m_watched.insert (id).second)
+      {
+        mobility->TraceConnectWithoutContext ("CourseChange",
+                                              MakeCallback (&BuildingPenetrationLossModel::CourseChange, this));
+      }
+    std::map<uint32_t, NodeState>::iterator it = m_nodes.find (id);
+    if (it != m_nodes.end () && Simulator::Now () < it->second.validUntil && it->second.moves == m_moves[id])
+      {
+        return it->second.building;
+      }
+
+    m_refreshes++;
+    NodeState &s = m_nodes[id];
+    s.moves = m_moves[id];
+    s.building = NONE;
+    Vector p = mobility->GetPosition ();
+    Vector v = mobility->GetVelocity ();
+    double next = std::numeric_limits<double>::infinity ();
+    for (BuildingList::Iterator bit = BuildingList::Begin (); bit != BuildingList::End (); ++bit)
+      {
+        Box box = (*bit)->GetBoundaries ();
+        if ((*bit)->IsInside (p))
+          {
+            s.building = (*bit)->GetId ();
+          }
+        next = std::min (next, Crossing (box, p, v));
+      }
+    //just past the wall, so the position is clearly on the other side
+    s.validUntil = next == std::numeric_limits<double>::infinity () ? Time::Max ()
+      : Simulator::Now () + Seconds (next) + MicroSeconds (1);
+    if (mobility->GetObject<MobilityBuildingInfo> () != 0)
+      {
+        BuildingsHelper::MakeConsistent (mobility);
+      }
+    return s.building;
+  }
+
+  void
+  CourseChange (Ptr<const MobilityModel> mobility) const
+  {
+    m_moves[mobility->GetObject<Node> ()->GetId ()]++;
+  }
+
+  //Seconds until the course p + v t first crosses a wall of the box,
+  //infinity if it never does
+  static double
+  Crossing (const Box &box, Vector p, Vector v)
+  {
+    double lo[3] = { box.xMin, box.yMin, box.zMin };
+    double hi[3] = { box.xMax, box.yMax, box.zMax };
+    double pos[3] = { p.x, p.y, p.z };
+    double vel[3] = { v.x, v.y, v.z };
+    double enter = -std::numeric_limits<double>::infinity ();
+    double leave = std::numeric_limits<double>::infinity ();
+    for (uint32_t k = 0; k < 3; ++k)
+      {
+        if (vel[k] == 0)
+          {
+            if (pos[k] < lo[k] || pos[k] > hi[k])
+              {
+                return std::numeric_limits<double>::infinity ();
+              }
+            continue;
+          }
+        double t1 = (lo[k] - pos[k]) / vel[k];
+        double t2 = (hi[k] - pos[k]) / vel[k];
+        enter = std::max (enter, std::min (t1, t2));
+        leave = std::min (leave, std::max (t1, t2));
+      }
+    if (enter > leave || leave <= 0)
+      {
+        return std::numeric_limits<double>::infinity ();
+      }
+    return enter > 0 ? enter : leave;
+  }
+
+  double m_wallLossDb;
+  mutable uint64_t m_refreshes;
+  mutable uint64_t m_queries;
+  mutable std::map<uint32_t, NodeState> m_nodes;
+  mutable std::map<uint32_t, uint32_t> m_moves; //course changes per node id
+  mutable std::set<uint32_t> m_watched;
+};
+
+NS_OBJECT_ENSURE_REGISTERED (BuildingPenetrationLossModel);
+
+inline Ptr<BuildingPenetrationLossModel>
+CreateBuildingPenetrationLoss (const BuildingGrid &g)
+{
+  Ptr<BuildingPenetrationLossModel> loss = CreateObject<BuildingPenetrationLossModel> ();
+  loss->SetAttribute ("WallLoss", DoubleValue (g.wallLossDb));
+  return loss;
+}
+
+//Friis pathloss followed by the wall loss, for helpers that only take the
+//type of the pathloss model, like the LteHelper
+class BuildingFriisPropagationLossModel : public PropagationLossModel
+{
+public:
+  static TypeId
+  GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("ns3::BuildingFriisPropagationLossModel")
+      .SetParent<PropagationLossModel> ()
+      .SetGroupName ("Buildings")
+      .AddConstructor<BuildingFriisPropagationLossModel> ()
+      .AddAttribute ("Frequency", "Carrier frequency of the Friis pathloss [Hz]",
+                     DoubleValue (5.15e9),
+                     MakeDoubleAccessor (&BuildingFriisPropagationLossModel::SetFrequency,
+                                         &BuildingFriisPropagationLossModel::GetFrequency),
+                     MakeDoubleChecker<double> ())
+      .AddAttribute ("Walls", "Wall loss added after the pathloss, none if unset",
+                     PointerValue (),
+                     MakePointerAccessor (&BuildingFriisPropagationLossModel::m_walls),
+                     MakePointerChecker<BuildingPenetrationLossModel> ());
+    return tid;
+  }
+
+  BuildingFriisPropagationLossModel ()
+    : m_friis (CreateObject<FriisPropagationLossModel> ())
+  {
+  }
+
+  void
+  SetFrequency (double frequency)
+  {
+    m_friis->SetFrequency (frequency);
+  }
+
+  double
+  GetFrequency () const
+  {
+    return m_friis->GetFrequency ();
+  }
+
+private:
+  virtual double
+  DoCalcRxPower (double txPowerDbm, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const
+  {
+    double rxPowerDbm = m_friis->CalcRxPower (txPowerDbm, a, b);
+    return m_walls == 0 ? rxPowerDbm : m_walls->CalcRxPower (rxPowerDbm, a, b);
+  }
+
+  virtual int64_t
+  DoAssignStreams (int64_t stream)
+  {
+    return 0;
+  }
+
+  Ptr<FriisPropagationLossModel> m_friis;
+  Ptr<BuildingPenetrationLossModel> m_walls;
+};
+
+NS_OBJECT_ENSURE_REGISTERED (BuildingFriisPropagationLossModel);
+
+//Use Friis plus the wall loss as the pathloss of both LTE channels. The
+//channels only take one loss model and the helper does not hand out the
+//one it creates, so call before the eNB devices are installed. The model
+//returned is shared by both channels.
+inline Ptr<BuildingPenetrationLossModel>
+InstallBuildingLoss (Ptr<LteHelper> helper, const BuildingGrid &g)
+{
+  if (g.blocks == 0)
+    {
+      return 0;
+    }
+  Ptr<BuildingPenetrationLossModel> loss = CreateBuildingPenetrationLoss (g);
+  helper->SetAttribute ("PathlossModel", StringValue ("ns3::BuildingFriisPropagationLossModel"));
+  helper->SetPathlossModelAttribute ("Walls", PointerValue (loss));
+  return loss;
+}
+
+//Add the wall loss right after the pathloss model of every mmWave carrier,
+//ahead of any loss already chained to it. Call after the MmWaveHelper has
+//been initialised.
+inline Ptr<BuildingPenetrationLossModel>
+InstallBuildingLoss (Ptr<mmwave::MmWaveHelper> helper, uint16_t numCcs, const BuildingGrid &g)
+{
+  if (g.blocks == 0)
+    {
+      return 0;
+    }
+  Ptr<BuildingPenetrationLossModel> loss = CreateBuildingPenetrationLoss (g);
+  for (uint16_t cc = 0; cc < numCcs; ++cc)
+    {
+      Ptr<PropagationLossModel> pathloss = helper->GetPathLossModel (cc);
+      if (pathloss->GetNext () == loss)
+        {
+          //carriers sharing one pathloss model
+          continue;
+        }
+      loss->SetNext (pathloss->GetNext ());
+      pathloss->SetNext (loss);
+    }
+  return loss;
+}
+
+inline void
+PrintBuildingGrid (const BuildingGrid &g, Ptr<BuildingPenetrationLossModel> loss, std::ostream &os = std::cout)
+{
+  if (g.blocks == 0)
+    {
+      return;
+    }
+  os << "Building grid: " << g.blocks * g.blocks << " buildings of " << g.blockSize << " m, "
+     << g.floors << " floors, " << g.streetWidth << " m streets, " << g.wallLossDb << " dB walls\n";
+  os << " Geometry lookups: " << loss->GetRefreshes () << " for " << loss->GetQueries () << " links\n";
+}
+
+} // namespace ns3
+
+#endif /* BUILDING_GRID_H */
@@ -0,0 +1,269 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//Carrier aggregation with any number of component carriers (CCs).
+//
+//The carrier manager of the eNB splits the downlink buffer of each UE over
+//the CCs. "rr" splits it in equal parts, "noop" keeps everything on the
+//primary CC and, on LTE, "load" splits it in proportion to the PRBs each CC
+//left free in its last TTI, so a busy CC gets less. CarrierStats reports
+//the throughput and utilisation of every CC.
+
+#ifndef CARRIER_AGGREGATION_H
+#define CARRIER_AGGREGATION_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/lte-module.h"
+#include "ns3/no-op-component-carrier-manager.h"
+#include "ns3/mmwave-phy-mac-common.h"
+#include "ns3/system-wall-clock-ms.h"
+
+#include "scheduler-stats.h"
+
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <vector>
+
+namespace ns3 {
+
+class LoadAwareComponentCarrierManager : public RrComponentCarrierManager
+{
+public:
+  static TypeId
+  GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("ns3::LoadAwareComponentCarrierManager")
+      .SetParent<RrComponentCarrierManager> ()
+      .SetGroupName ("Lte")
+      .AddConstructor<LoadAwareComponentCarrierManager> ();
+    return tid;
+  }
+
+protected:
+  virtual void
+  DoReportBufferStatus (LteMacSapProvider::ReportBufferStatusParameters params)
+  {
+    uint32_t numberOfCarriersForUe = m_enabledComponentCarrier.find (params.rnti)->second;
+    if (params.lcid == 0 || params.lcid == 1 || numberOfCarriersForUe == 1)
+      {
+        //signalling and single carrier UEs stay on the primary CC
+        RrComponentCarrierManager::DoReportBufferStatus (params);
+        return;
+      }
+
+    //a CC with no report yet counts as free, and a full one still gets a
+    //little so its scheduler sees the UE
+    double total = 0.0;
+    std::vector<double> weight (numberOfCarriersForUe);
+    for (uint32_t cc = 0; cc < numberOfCarriersForUe; ++cc)
+      {
+        std::map<uint8_t, double>::const_iterator occupancy = m_ccPrbOccupancy.find (cc);
+        weight[cc] = std::max (0.05, 1.0 - (occupancy == m_ccPrbOccupancy.end () ? 0.0 : occupancy->second));
+        total += weight[cc];
+      }
+    for (uint32_t cc = 0; cc < numberOfCarriersForUe; ++cc)
+      {
+        LteMacSapProvider::ReportBufferStatusParameters share = params;
+        share.txQueueSize = static_cast<uint32_t> (params.txQueueSize * weight[cc] / total);
+        share.retxQueueSize = static_cast<uint32_t> (params.retxQueueSize * weight[cc] / total);
+        m_macSapProvidersMap.find (cc)->second->ReportBufferStatus (share);
+      }
+  }
+};
+
+NS_OBJECT_ENSURE_REGISTERED (LoadAwareComponentCarrierManager);
+
+//Set the LteHelper defaults for numCcs carriers of ccBandwidth RBs each
+inline void
+ConfigureLteCa (uint16_t numCcs, uint16_t ccBandwidth, std::string manager)
+{
+  NS_ABORT_MSG_IF (numCcs < 1 || numCcs > MAX_NO_CC, "LTE supports 1 to " << MAX_NO_CC << " component carriers");
+  NS_ABORT_MSG_IF (ccBandwidth != 6 && ccBandwidth != 15 && ccBandwidth != 25 && ccBandwidth != 50
+                   && ccBandwidth != 75 && ccBandwidth != 100,
+                   "LTE carriers have 6, 15, 25, 50, 75 or 100 RBs, not " << ccBandwidth);
+  std::string type;
+  if (manager == "rr")
+    {
+      type = "ns3::RrComponentCarrierManager";
+    }
+  else if (manager == "load")
+    {
+      type = "ns3::LoadAwareComponentCarrierManager";
+    }
+  else if (manager == "noop")
+    {
+      type = "ns3::NoOpComponentCarrierManager";
+    }
+  else
+    {
+      NS_FATAL_ERROR ("Unknown LTE carrier manager " << manager << ", use rr, load or noop");
+    }
+  Config::SetDefault ("ns3::LteHelper::UseCa", BooleanValue (true));
+  Config::SetDefault ("ns3::LteHelper::NumberOfComponentCarriers", UintegerValue (numCcs));
+  Config::SetDefault ("ns3::LteHelper::EnbComponentCarrierManager", StringValue (type));
+  Config::SetDefault ("ns3::LteEnbNetDevice::DlBandwidth", UintegerValue (ccBandwidth));
+  Config::SetDefault ("ns3::LteEnbNetDevice::UlBandwidth", UintegerValue (ccBandwidth));
+}
+
+//Set the MmWaveHelper defaults for numCcs carriers, each with the
+//numerology of the MmWavePhyMacCommon defaults
+inline void
+ConfigureMmWaveCa (uint16_t numCcs, std::string manager)
+{
+  NS_ABORT_MSG_IF (numCcs < 1, "At least one component carrier is needed");
+  std::string type;
+  if (manager == "rr")
+    {
+      type = "ns3::MmWaveRrComponentCarrierManager";
+    }
+  else if (manager == "noop")
+    {
+      type = "ns3::MmWaveNoOpComponentCarrierManager";
+    }
+  else
+    {
+      NS_FATAL_ERROR ("Unknown mmWave carrier manager " << manager << ", use rr or noop");
+    }
+  Config::SetDefault ("ns3::MmWaveHelper::UseCa", BooleanValue (true));
+  Config::SetDefault ("ns3::MmWaveHelper::NumberOfComponentCarriers", UintegerValue (numCcs));
+  Config::SetDefault ("ns3::MmWaveHelper::EnbComponentCarrierManager", StringValue (type));
+}
+
+//Downlink bytes and resource use per CC. LTE counts the PRBs of every
+//allocation the eNB MACs schedule; mmWave has no such trace, so the TBs
+//the UEs decode are counted with the OFDM symbols they took.
+class CarrierStats
+{
+public:
+  CarrierStats ()
+    : m_resourcesPerSecond (0),
+      m_maxPrbs (0),
+      m_wallMs (-1)
+  {
+  }
+
+  void
+  InstallLte (NetDeviceContainer enbDevs, Time start)
+  {
+    m_start = start;
+    m_unit = "PRB";
+    for (uint32_t e = 0; e < enbDevs.GetN (); ++e)
+      {
+        Ptr<LteEnbNetDevice> enb = enbDevs.Get (e)->GetObject<LteEnbNetDevice> ();
+        m_maxPrbs = std::max<uint16_t> (m_maxPrbs, enb->GetDlBandwidth ());
+      }
+    //every CC of every eNB has m_maxPrbs PRBs per 1ms TTI
+    m_resourcesPerSecond = 1000.0 * m_maxPrbs * enbDevs.GetN ();
+    m_amc = CreateObject<LteAmc> ();
+    Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/ComponentCarrierMap/*/LteEnbMac/DlScheduling",
+                                   MakeCallback (&CarrierStats::DlScheduling, this));
+  }
+
+  //Every CC has the numerology of the MmWavePhyMacCommon defaults
+  void
+  InstallMmWave (uint32_t numEnbs, Time start)
+  {
+    m_start = start;
+    m_unit = "symbol";
+    Ptr<MmWavePhyMacCommon> phy = CreateObject<MmWavePhyMacCommon> ();
+    m_resourcesPerSecond = 1e6 * phy->GetSymbolsPerSubframe () / phy->GetSubframePeriod () * numEnbs;
+    Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/ComponentCarrierMapUe/*/MmWaveUePhy/DlSpectrumPhy/RxPacketTraceUe",
+                                   MakeCallback (&CarrierStats::RxPacketTraceUe, this));
+  }
+
+  //Time Simulator::Run with these around it
+  void
+  StartClock ()
+  {
+    m_clock.Start ();
+  }
+
+  void
+  StopClock ()
+  {
+    m_wallMs = m_clock.End ();
+  }
+
+  //Wall clock time of Simulator::Run, -1 when it was not timed
+  int64_t
+  GetWallMs () const
+  {
+    return m_wallMs;
+  }
+
+  void
+  Print (std::ostream &os = std::cout) const
+  {
+    double seconds = (Simulator::Now () - m_start).GetSeconds ();
+    uint64_t totalBytes = 0;
+    for (std::map<uint8_t, double>::const_iterator cc = m_resources.begin (); cc != m_resources.end (); ++cc)
+      {
+        std::map<uint8_t, uint64_t>::const_iterator bytes = m_bytes.find (cc->first);
+        uint64_t ccBytes = bytes == m_bytes.end () ? 0 : bytes->second;
+        os << "Component Carrier " << static_cast<uint32_t> (cc->first) << "\n";
+        os << " DL Throughput: " << GoodputMbps (ccBytes, seconds) << " Mbps\n";
+        os << " " << m_unit << " Utilisation: " << 100 * SafeRatio (cc->second, m_resourcesPerSecond * seconds) << " %\n";
+        totalBytes += ccBytes;
+      }
+    os << "All Carriers DL Throughput: " << GoodputMbps (totalBytes, seconds) << " Mbps\n";
+    if (m_wallMs >= 0)
+      {
+        os << " Wall Clock: " << m_wallMs << " ms\n";
+      }
+  }
+
+private:
+  void
+  DlScheduling (DlSchedulingCallbackInfo info)
+  {
+    if (Simulator::Now () < m_start)
+      {
+        return;
+      }
+    m_bytes[info.componentCarrierId] += info.sizeTb1 + info.sizeTb2;
+    m_resources[info.componentCarrierId] += DlPrbsFromTb (m_amc, info.mcsTb1, info.sizeTb1, m_maxPrbs);
+  }
+
+  void
+  RxPacketTraceUe (RxPacketTraceParams params)
+  {
+    if (Simulator::Now () < m_start)
+      {
+        return;
+      }
+    if (!params.m_corrupt)
+      {
+        m_bytes[params.m_ccId] += params.m_tbSize;
+      }
+    m_resources[params.m_ccId] += params.m_numSym;
+  }
+
+  Time m_start;
+  std::string m_unit;
+  double m_resourcesPerSecond; //of one CC over all eNBs
+  Ptr<LteAmc> m_amc;
+  uint16_t m_maxPrbs;
+  SystemWallClockMs m_clock;
+  int64_t m_wallMs;
+  std::map<uint8_t, uint64_t> m_bytes;
+  std::map<uint8_t, double> m_resources;
+};
+
+} // namespace ns3
+
+#endif /* CARRIER_AGGREGATION_H */
@@ -0,0 +1,148 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//Core network wiring shared by the scenarios, following lena-simple-epc:
+//servers are remote hosts behind the PGW and the UEs get their addresses
+//from the EPC, so all traffic crosses the radio and the bearers. Works
+//with both the LTE and the mmWave EPC helpers.
+
+#ifndef EPC_TOPOLOGY_H
+#define EPC_TOPOLOGY_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/epc-helper.h"
+
+#include <vector>
+
+namespace ns3 {
+
+//Connect a remote host to the PGW with the given link and route the UE
+//network (7.0.0.0/8 or 7777:f00d::/64) back through the PGW. Every call
+//uses a new network, so several servers can be connected. Returns the
+//address of the remote host.
+inline Address
+ConnectRemoteHost (Ptr<EpcHelper> epcHelper, Ptr<Node> remoteHost, PointToPointHelper &p2p, bool useV6)
+{
+  static Ipv4AddressHelper ipv4 ("1.0.0.0", "255.255.255.0");
+  static Ipv6AddressHelper ipv6 ("6001:db80::", Ipv6Prefix (64));
+
+  NetDeviceContainer devices = p2p.Install (epcHelper->GetPgwNode (), remoteHost);
+  if (useV6 == false)
+    {
+      Ipv4InterfaceContainer i = ipv4.Assign (devices);
+      ipv4.NewNetwork ();
+
+      Ipv4StaticRoutingHelper ipv4RoutingHelper;
+      Ptr<Ipv4> hostIpv4 = remoteHost->GetObject<Ipv4> ();
+      Ptr<Ipv4StaticRouting> hostStaticRouting = ipv4RoutingHelper.GetStaticRouting (hostIpv4);
+      hostStaticRouting->AddNetworkRouteTo (Ipv4Address ("7.0.0.0"), Ipv4Mask ("255.0.0.0"),
+                                            hostIpv4->GetInterfaceForDevice (devices.Get (1)));
+      return Address (i.GetAddress (1));
+    }
+
+  Ipv6InterfaceContainer i6 = ipv6.Assign (devices);
+  ipv6.NewNetwork ();
+  i6.SetForwarding (0, true);
+  i6.SetDefaultRouteInAllNodes (0);
+
+  Ipv6StaticRoutingHelper ipv6RoutingHelper;
+  Ptr<Ipv6> hostIpv6 = remoteHost->GetObject<Ipv6> ();
+  Ptr<Ipv6StaticRouting> hostStaticRouting = ipv6RoutingHelper.GetStaticRouting (hostIpv6);
+  hostStaticRouting->AddNetworkRouteTo ("7777:f00d::", Ipv6Prefix (64), i6.GetAddress (0, 1),
+                                        hostIpv6->GetInterfaceForDevice (devices.Get (1)), 0);
+  return Address (i6.GetAddress (1, 1));
+}
+
+//Give the UEs their EPC addresses and a default route to the PGW. Must be
+//called before the UEs attach, attaching activates the default bearer and
+//that needs the UE address.
+inline std::vector<Address>
+AssignUeAddresses (Ptr<EpcHelper> epcHelper, NodeContainer ueNodes, NetDeviceContainer ueDevs, bool useV6)
+{
+  std::vector<Address> addresses;
+  if (useV6 == false)
+    {
+      Ipv4StaticRoutingHelper ipv4RoutingHelper;
+      Ipv4InterfaceContainer ueIpIface = epcHelper->AssignUeIpv4Address (ueDevs);
+      for (uint32_t u = 0; u < ueNodes.GetN (); ++u)
+        {
+          Ptr<Ipv4> ueIpv4 = ueNodes.Get (u)->GetObject<Ipv4> ();
+          Ptr<Ipv4StaticRouting> ueStaticRouting = ipv4RoutingHelper.GetStaticRouting (ueIpv4);
+          ueStaticRouting->SetDefaultRoute (epcHelper->GetUeDefaultGatewayAddress (),
+                                            ueIpv4->GetInterfaceForDevice (ueDevs.Get (u)));
+          addresses.push_back (Address (ueIpIface.GetAddress (u)));
+        }
+      return addresses;
+    }
+
+  Ipv6StaticRoutingHelper ipv6RoutingHelper;
+  Ipv6InterfaceContainer ueIpIface = epcHelper->AssignUeIpv6Address (ueDevs);
+  for (uint32_t u = 0; u < ueNodes.GetN (); ++u)
+    {
+      Ptr<Ipv6> ueIpv6 = ueNodes.Get (u)->GetObject<Ipv6> ();
+      Ptr<Ipv6StaticRouting> ueStaticRouting = ipv6RoutingHelper.GetStaticRouting (ueIpv6);
+      ueStaticRouting->SetDefaultRoute (epcHelper->GetUeDefaultGatewayAddress6 (),
+                                        ueIpv6->GetInterfaceForDevice (ueDevs.Get (u)));
+      addresses.push_back (Address (ueIpIface.GetAddress (u, 1)));
+    }
+  return addresses;
+}
+
+//Socket address for an Ipv4Address or Ipv6Address held in an Address
+inline Address
+SocketAddress (const Address &ip, uint16_t port)
+{
+  if (Ipv4Address::IsMatchingType (ip))
+    {
+      return InetSocketAddress (Ipv4Address::ConvertFrom (ip), port);
+    }
+  return Inet6SocketAddress (Ipv6Address::ConvertFrom (ip), port);
+}
+
+//Wildcard socket address for servers and sinks
+inline Address
+AnySocketAddress (bool useV6, uint16_t port)
+{
+  if (useV6 == false)
+    {
+      return InetSocketAddress (Ipv4Address::GetAny (), port);
+    }
+  return Inet6SocketAddress (Ipv6Address::GetAny (), port);
+}
+
+//Which end of a scenario sends: ul (the UE to the server), dl (the server
+//to the UE) or both, each direction its own application pair
+struct TrafficDirection
+{
+  bool ul;
+  bool dl;
+};
+
+inline TrafficDirection
+ParseDirection (std::string direction)
+{
+  NS_ABORT_MSG_IF (direction != "ul" && direction != "dl" && direction != "both",
+                   "Unknown direction " << direction << ", use ul, dl or both");
+  TrafficDirection d = { direction != "dl", direction != "ul" };
+  return d;
+}
+
+} // namespace ns3
+
+#endif /* EPC_TOPOLOGY_H */
@@ -0,0 +1,439 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//Shared FlowMonitor post-processing used by every scenario.
+//All rates are SI (1 Mbps = 1e6 bit/s) and all delays are reported in ms.
+
+#ifndef FLOW_METRICS_H
+#define FLOW_METRICS_H
+
+#include "ns3/flow-monitor.h"
+#include "ns3/flow-monitor-helper.h"
+#include "ns3/histogram.h"
+#include "ns3/ipv4.h"
+#include "ns3/ipv6.h"
+#include "ns3/ipv4-flow-classifier.h"
+#include "ns3/ipv6-flow-classifier.h"
+#include "ns3/ipv6-flow-probe.h"
+
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <vector>
+
+namespace ns3 {
+
+//Metrics derived from a single FlowMonitor::FlowStats entry
+struct FlowMetrics
+{
+  uint64_t txBytes;
+  uint64_t rxBytes;
+  uint32_t txPackets;
+  uint32_t rxPackets;
+  uint32_t lostPackets;
+  double durationS;     //first tx to last rx [s]
+  double goodputMbps;   //rx bits over durationS [Mbps]
+  double meanDelayMs;   //delaySum / rxPackets
+  double p50DelayMs;
+  double p95DelayMs;
+  double p99DelayMs;
+  double meanJitterMs;  //jitterSum / (rxPackets - 1)
+  double lossRatio;     //lostPackets / txPackets
+  bool degenerate;      //fewer than two packets received or zero duration
+};
+
+//Goodput in Mbps, zero when the observation window is empty
+inline double
+GoodputMbps (uint64_t rxBytes, double durationS)
+{
+  if (durationS <= 0.0)
+    {
+      return 0.0;
+    }
+  return rxBytes * 8.0 / durationS / 1e6;
+}
+
+//Ratio of two counters, zero when the denominator is zero
+inline double
+SafeRatio (double num, double den)
+{
+  return den > 0.0 ? num / den : 0.0;
+}
+
+//Jain's fairness index of a set of rates, 1 when all are equal and 1/n
+//when one gets everything
+inline double
+JainIndex (const std::vector<double> &x)
+{
+  double sum = 0.0, sumSquares = 0.0;
+  for (uint32_t i = 0; i < x.size (); ++i)
+    {
+      sum += x[i];
+      sumSquares += x[i] * x[i];
+    }
+  return SafeRatio (sum * sum, x.size () * sumSquares);
+}
+
+//Value below which a fraction q (0..1) of the histogram samples fall.
+//Samples are assumed uniformly spread inside each bin.
+inline double
+HistogramPercentile (Histogram hist, double q)
+{
+  uint64_t total = 0;
+  for (uint32_t b = 0; b < hist.GetNBins (); ++b)
+    {
+      total += hist.GetBinCount (b);
+    }
+  if (total == 0)
+    {
+      return 0.0;
+    }
+
+  double target = q * total;
+  uint64_t seen = 0;
+  for (uint32_t b = 0; b < hist.GetNBins (); ++b)
+    {
+      uint32_t count = hist.GetBinCount (b);
+      if (count > 0 && seen + count >= target)
+        {
+          double frac = (target - seen) / count;
+          return hist.GetBinStart (b) + frac * hist.GetBinWidth (b);
+        }
+      seen += count;
+    }
+  return hist.GetBinEnd (hist.GetNBins () - 1);
+}
+
+inline FlowMetrics
+ComputeFlowMetrics (const FlowMonitor::FlowStats &st)
+{
+  FlowMetrics m;
+  m.txBytes = st.txBytes;
+  m.rxBytes = st.rxBytes;
+  m.txPackets = st.txPackets;
+  m.rxPackets = st.rxPackets;
+  m.lostPackets = st.lostPackets;
+  m.durationS = (st.timeLastRxPacket - st.timeFirstTxPacket).GetSeconds ();
+  m.degenerate = st.rxPackets < 2 || m.durationS <= 0.0;
+
+  m.goodputMbps = m.degenerate ? 0.0 : GoodputMbps (st.rxBytes, m.durationS);
+  m.meanDelayMs = SafeRatio (st.delaySum.GetSeconds (), st.rxPackets) * 1e3;
+  m.meanJitterMs = st.rxPackets > 1 ? st.jitterSum.GetSeconds () / (st.rxPackets - 1) * 1e3 : 0.0;
+  m.p50DelayMs = HistogramPercentile (st.delayHistogram, 0.50) * 1e3;
+  m.p95DelayMs = HistogramPercentile (st.delayHistogram, 0.95) * 1e3;
+  m.p99DelayMs = HistogramPercentile (st.delayHistogram, 0.99) * 1e3;
+  m.lossRatio = SafeRatio (st.lostPackets, st.txPackets);
+  return m;
+}
+
+inline void
+PrintFlowMetrics (std::ostream &os, const FlowMetrics &m)
+{
+  os << " Tx Bytes: " << m.txBytes << "\n";
+  os << " Rx Bytes: " << m.rxBytes << "\n";
+  if (m.degenerate)
+    {
+      os << " Goodput: n/a (fewer than 2 packets received)\n";
+    }
+  else
+    {
+      os << " Goodput: " << m.goodputMbps << " Mbps\n";
+    }
+  os << " Mean Delay: " << m.meanDelayMs << " ms"
+     << " (p50 " << m.p50DelayMs << ", p95 " << m.p95DelayMs << ", p99 " << m.p99DelayMs << " ms)\n";
+  os << " Mean Jitter: " << m.meanJitterMs << " ms\n";
+  os << " Lost Packets: " << m.lostPackets << " (loss ratio " << m.lossRatio << ")\n";
+}
+
+//Add the samples of one histogram to another with the same bin width
+inline void
+AddHistogram (Histogram &into, Histogram from)
+{
+  for (uint32_t b = 0; b < from.GetNBins (); ++b)
+    {
+      double centre = from.GetBinStart (b) + from.GetBinWidth (b) / 2;
+      for (uint32_t k = from.GetBinCount (b); k > 0; --k)
+        {
+          into.AddValue (centre);
+        }
+    }
+}
+
+//Add the counters and histograms of one flow to another, so a group of
+//flows (an application, a direction) can be reported as one
+inline void
+MergeFlowStats (FlowMonitor::FlowStats &into, const FlowMonitor::FlowStats &from)
+{
+  into.timeFirstTxPacket = std::min (into.timeFirstTxPacket, from.timeFirstTxPacket);
+  into.timeFirstRxPacket = std::min (into.timeFirstRxPacket, from.timeFirstRxPacket);
+  into.timeLastTxPacket = std::max (into.timeLastTxPacket, from.timeLastTxPacket);
+  into.timeLastRxPacket = std::max (into.timeLastRxPacket, from.timeLastRxPacket);
+  into.delaySum += from.delaySum;
+  into.jitterSum += from.jitterSum;
+  into.txBytes += from.txBytes;
+  into.rxBytes += from.rxBytes;
+  into.txPackets += from.txPackets;
+  into.rxPackets += from.rxPackets;
+  into.lostPackets += from.lostPackets;
+  into.timesForwarded += from.timesForwarded;
+  AddHistogram (into.delayHistogram, from.delayHistogram);
+  AddHistogram (into.jitterHistogram, from.jitterHistogram);
+  AddHistogram (into.packetSizeHistogram, from.packetSizeHistogram);
+}
+
+//Sum of the goodput of all non-degenerate flows seen by the monitor
+inline double
+TotalGoodputMbps (Ptr<FlowMonitor> flowMonitor)
+{
+  double total = 0.0;
+  FlowMonitor::FlowStatsContainer stats = flowMonitor->GetFlowStats ();
+  for (std::map<FlowId, FlowMonitor::FlowStats>::const_iterator i = stats.begin (); i != stats.end (); ++i)
+    {
+      total += ComputeFlowMetrics (i->second).goodputMbps;
+    }
+  return total;
+}
+
+//Jain's index over the goodput of all non-degenerate flows
+inline double
+FlowJainIndex (Ptr<FlowMonitor> flowMonitor)
+{
+  std::vector<double> goodputs;
+  FlowMonitor::FlowStatsContainer stats = flowMonitor->GetFlowStats ();
+  for (std::map<FlowId, FlowMonitor::FlowStats>::const_iterator i = stats.begin (); i != stats.end (); ++i)
+    {
+      FlowMetrics m = ComputeFlowMetrics (i->second);
+      if (!m.degenerate)
+        {
+          goodputs.push_back (m.goodputMbps);
+        }
+    }
+  return JainIndex (goodputs);
+}
+
+//Five-tuple of a flow from whichever classifier saw it
+struct FlowTuple
+{
+  bool ipv6;
+  Ipv4Address source4;
+  Ipv4Address destination4;
+  Ipv6Address source6;
+  Ipv6Address destination6;
+  uint8_t protocol;
+  uint16_t sourcePort;
+  uint16_t destinationPort;
+};
+
+inline std::ostream &
+operator<< (std::ostream &os, const FlowTuple &t)
+{
+  if (t.ipv6)
+    {
+      os << "IPv6 " << t.source6 << " -> " << t.destination6;
+    }
+  else
+    {
+      os << "IPv4 " << t.source4 << " -> " << t.destination4;
+    }
+  return os;
+}
+
+//The IPv4 and IPv6 classifiers number their flows independently and each
+//aborts on an unknown id, so the family is taken from the probes that
+//recorded the flow
+inline bool
+IsIpv6Flow (Ptr<FlowMonitor> flowMonitor, FlowId flowId)
+{
+  const FlowMonitor::FlowProbeContainer &probes = flowMonitor->GetAllProbes ();
+  for (uint32_t p = 0; p < probes.size (); ++p)
+    {
+      if (DynamicCast<Ipv6FlowProbe> (probes[p]))
+        {
+          FlowProbe::Stats stats = probes[p]->GetStats ();
+          if (stats.find (flowId) != stats.end ())
+            {
+              return true;
+            }
+        }
+    }
+  return false;
+}
+
+inline FlowTuple
+FindFlowTuple (Ptr<FlowMonitor> flowMonitor, FlowMonitorHelper &flowHelper, FlowId flowId)
+{
+  FlowTuple t;
+  t.ipv6 = IsIpv6Flow (flowMonitor, flowId);
+  if (t.ipv6)
+    {
+      Ptr<Ipv6FlowClassifier> classifier = DynamicCast<Ipv6FlowClassifier> (flowHelper.GetClassifier6 ());
+      Ipv6FlowClassifier::FiveTuple f = classifier->FindFlow (flowId);
+      t.source6 = f.sourceAddress;
+      t.destination6 = f.destinationAddress;
+      t.protocol = f.protocol;
+      t.sourcePort = f.sourcePort;
+      t.destinationPort = f.destinationPort;
+    }
+  else
+    {
+      Ptr<Ipv4FlowClassifier> classifier = DynamicCast<Ipv4FlowClassifier> (flowHelper.GetClassifier ());
+      Ipv4FlowClassifier::FiveTuple f = classifier->FindFlow (flowId);
+      t.source4 = f.sourceAddress;
+      t.destination4 = f.destinationAddress;
+      t.protocol = f.protocol;
+      t.sourcePort = f.sourcePort;
+      t.destinationPort = f.destinationPort;
+    }
+  return t;
+}
+
+//True when the flow starts or ends at one of the node's addresses
+inline bool
+FlowTouchesNode (const FlowTuple &t, Ptr<Node> node)
+{
+  if (t.ipv6)
+    {
+      Ptr<Ipv6> ipv6 = node->GetObject<Ipv6> ();
+      return ipv6 && (ipv6->GetInterfaceForAddress (t.source6) >= 0
+                      || ipv6->GetInterfaceForAddress (t.destination6) >= 0);
+    }
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  return ipv4 && (ipv4->GetInterfaceForAddress (t.source4) >= 0
+                  || ipv4->GetInterfaceForAddress (t.destination4) >= 0);
+}
+
+//True when the flow starts at one of the node's addresses
+inline bool
+FlowFromNode (const FlowTuple &t, Ptr<Node> node)
+{
+  if (t.ipv6)
+    {
+      Ptr<Ipv6> ipv6 = node->GetObject<Ipv6> ();
+      return ipv6 && ipv6->GetInterfaceForAddress (t.source6) >= 0;
+    }
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  return ipv4 && ipv4->GetInterfaceForAddress (t.source4) >= 0;
+}
+
+//True when b is the flow going back the way a came, as the ACKs of a TCP
+//connection or the requests of an HTTP download
+inline bool
+IsReverseFlow (const FlowTuple &a, const FlowTuple &b)
+{
+  if (a.ipv6 != b.ipv6 || a.protocol != b.protocol
+      || a.sourcePort != b.destinationPort || a.destinationPort != b.sourcePort)
+    {
+      return false;
+    }
+  if (a.ipv6)
+    {
+      return a.source6 == b.destination6 && a.destination6 == b.source6;
+    }
+  return a.source4 == b.destination4 && a.destination4 == b.source4;
+}
+
+//Share of the sent bytes taken by the fixed IP header (20 bytes for IPv4,
+//40 bytes for IPv6), FlowMonitor counts packet sizes at the IP layer
+inline double
+IpHeaderOverhead (const FlowMonitor::FlowStats &st, bool ipv6)
+{
+  return SafeRatio ((ipv6 ? 40.0 : 20.0) * st.txPackets, st.txBytes);
+}
+
+//Print every IPv4 and IPv6 flow seen by the monitor, replaces the
+//per-scenario stats loop
+inline void
+PrintFlowMetrics (Ptr<FlowMonitor> flowMonitor, FlowMonitorHelper &flowHelper, std::ostream &os = std::cout)
+{
+  FlowMonitor::FlowStatsContainer stats = flowMonitor->GetFlowStats ();
+  for (std::map<FlowId, FlowMonitor::FlowStats>::const_iterator i = stats.begin (); i != stats.end (); ++i)
+    {
+      FlowTuple t = FindFlowTuple (flowMonitor, flowHelper, i->first);
+      os << "Flow " << i->first << " (" << t << ")\n";
+      PrintFlowMetrics (os, ComputeFlowMetrics (i->second));
+      os << " IP Header Overhead: " << IpHeaderOverhead (i->second, t.ipv6) * 100 << " %\n";
+    }
+}
+
+//The flows from the UE (UL) and to it (DL) merged per direction. Of a
+//flow and its reverse flow only the one carrying more bytes is merged, the
+//other (TCP ACKs, HTTP requests) is reported apart as reverse traffic of
+//the direction it goes, so it does not dilute the delay and goodput there.
+inline void
+PrintDirectionMetrics (Ptr<FlowMonitor> flowMonitor, FlowMonitorHelper &flowHelper, Ptr<Node> ue,
+                       std::ostream &os = std::cout)
+{
+  FlowMonitor::FlowStatsContainer stats = flowMonitor->GetFlowStats ();
+  std::map<FlowId, FlowTuple> tuples;
+  for (std::map<FlowId, FlowMonitor::FlowStats>::const_iterator i = stats.begin (); i != stats.end (); ++i)
+    {
+      tuples[i->first] = FindFlowTuple (flowMonitor, flowHelper, i->first);
+    }
+
+  std::map<bool, FlowMonitor::FlowStats> perDirection; //true for UL
+  std::map<bool, uint64_t> reverseBytes;
+  std::map<bool, uint32_t> reversePackets;
+  for (std::map<FlowId, FlowMonitor::FlowStats>::const_iterator i = stats.begin (); i != stats.end (); ++i)
+    {
+      const FlowTuple &t = tuples[i->first];
+      bool ul = FlowFromNode (t, ue);
+      bool reverse = false;
+      for (std::map<FlowId, FlowTuple>::const_iterator r = tuples.begin (); r != tuples.end (); ++r)
+        {
+          if (IsReverseFlow (r->second, t))
+            {
+              const FlowMonitor::FlowStats &other = stats[r->first];
+              reverse = other.rxBytes > i->second.rxBytes
+                        || (other.rxBytes == i->second.rxBytes && r->first < i->first);
+              break;
+            }
+        }
+      if (reverse)
+        {
+          reverseBytes[ul] += i->second.txBytes;
+          reversePackets[ul] += i->second.txPackets;
+          continue;
+        }
+      std::map<bool, FlowMonitor::FlowStats>::iterator merged = perDirection.find (ul);
+      if (merged == perDirection.end ())
+        {
+          perDirection[ul] = i->second;
+        }
+      else
+        {
+          MergeFlowStats (merged->second, i->second);
+        }
+    }
+  for (int d = 0; d < 2; ++d)
+    {
+      bool ul = d == 1;
+      std::string direction = ul ? "Uplink" : "Downlink";
+      if (perDirection.find (ul) != perDirection.end ())
+        {
+          os << direction << " (all flows)\n";
+          PrintFlowMetrics (os, ComputeFlowMetrics (perDirection[ul]));
+        }
+      if (reversePackets[ul] > 0)
+        {
+          os << direction << " reverse traffic (TCP ACKs, HTTP requests): " << reverseBytes[ul] << " bytes in "
+             << reversePackets[ul] << " packets\n";
+        }
+    }
+}
+
+} // namespace ns3
+
+#endif /* FLOW_METRICS_H */
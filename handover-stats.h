@@ -0,0 +1,387 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//Per-UE handover instrumentation for the LTE scenarios that use the EPC and X2.
+//
+//One CSV record is written per event:
+//  time_s,imsi,event,sourceCell,targetCell,execMs,interruptMs,x2Bytes,pingPong
+//where event is HO (completed handover), HO_FAIL or RLF. execMs is the RRC
+//handover execution time (HandoverStart to HandoverEndOk) and interruptMs is
+//the user plane gap, i.e. last packet received before the handover to the
+//first packet received after it. x2Bytes is the data the source forwarded
+//over X2-U, told apart by the GTP-U TEID of the UE's bearers.
+
+#ifndef HANDOVER_STATS_H
+#define HANDOVER_STATS_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/lte-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/epc-gtpu-header.h"
+#include "ns3/lte-radio-bearer-info.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+namespace ns3 {
+
+class HandoverStats
+{
+public:
+  //X2-U reuses the GTP-U port, X2-C signalling uses the EpcX2 default port
+  static const uint16_t X2U_PORT = 2152;
+
+  HandoverStats (std::string filename, Time pingPongWindow)
+    : m_pingPongWindow (pingPongWindow),
+      m_x2cBytes (0),
+      m_x2uUnattributed (0)
+  {
+    m_out.open (filename.c_str ());
+    m_out << "time_s,imsi,event,sourceCell,targetCell,execMs,interruptMs,x2Bytes,pingPong\n";
+  }
+
+  //Hook the UE RRC, UE IP receive and eNB X2 traces. Call after the X2
+  //interfaces have been added and the UE devices installed.
+  void
+  Install (NodeContainer ueNodes, NetDeviceContainer ueDevs,
+           NodeContainer enbNodes, NetDeviceContainer enbDevs)
+  {
+    for (uint32_t u = 0; u < ueDevs.GetN (); ++u)
+      {
+        uint64_t imsi = ueDevs.Get (u)->GetObject<LteUeNetDevice> ()->GetImsi ();
+        uint32_t nodeId = ueNodes.Get (u)->GetId ();
+        m_imsiByNode[nodeId] = imsi;
+        m_ues[imsi];
+
+        std::ostringstream path;
+        path << "/NodeList/" << nodeId;
+        Config::Connect (path.str () + "/$ns3::Ipv4L3Protocol/Rx",
+                         MakeCallback (&HandoverStats::UeRxV4, this));
+        Config::Connect (path.str () + "/$ns3::Ipv6L3Protocol/Rx",
+                         MakeCallback (&HandoverStats::UeRxV6, this));
+      }
+
+    Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/LteUeRrc/HandoverStart",
+                                   MakeCallback (&HandoverStats::HandoverStart, this));
+    Config::Connect ("/NodeList/*/DeviceList/*/LteEnbRrc/HandoverStart",
+                     MakeCallback (&HandoverStats::SourceHandoverStart, this));
+    Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/LteUeRrc/HandoverEndOk",
+                                   MakeCallback (&HandoverStats::HandoverEndOk, this));
+    Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/LteUeRrc/HandoverEndError",
+                                   MakeCallback (&HandoverStats::HandoverEndError, this));
+    //Radio link failure detection is only present in newer LTE modules
+    if (LteUeRrc::GetTypeId ().LookupTraceSourceByName ("RadioLinkFailure") != 0)
+      {
+        Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/LteUeRrc/RadioLinkFailure",
+                                       MakeCallback (&HandoverStats::RadioLinkFailure, this));
+      }
+
+    //The X2 links are the point-to-point devices joining two eNBs
+    std::map<uint32_t, uint16_t> cellByNode;
+    for (uint32_t e = 0; e < enbDevs.GetN (); ++e)
+      {
+        cellByNode[enbNodes.Get (e)->GetId ()] = enbDevs.Get (e)->GetObject<LteEnbNetDevice> ()->GetCellId ();
+      }
+    for (uint32_t e = 0; e < enbNodes.GetN (); ++e)
+      {
+        Ptr<Node> enb = enbNodes.Get (e);
+        for (uint32_t d = 0; d < enb->GetNDevices (); ++d)
+          {
+            Ptr<PointToPointNetDevice> dev = DynamicCast<PointToPointNetDevice> (enb->GetDevice (d));
+            if (dev == 0)
+              {
+                continue;
+              }
+            Ptr<Channel> ch = dev->GetChannel ();
+            Ptr<NetDevice> peer = ch->GetDevice (0) == dev ? ch->GetDevice (1) : ch->GetDevice (0);
+            if (cellByNode.find (peer->GetNode ()->GetId ()) == cellByNode.end ())
+              {
+                continue;
+              }
+            dev->TraceConnectWithoutContext ("MacTx", MakeCallback (&HandoverStats::X2Tx, this));
+          }
+      }
+  }
+
+  //Flush pending records and print the per-UE summary
+  void
+  Finish (std::ostream &os = std::cout)
+  {
+    for (std::map<uint64_t, UeState>::iterator it = m_ues.begin (); it != m_ues.end (); ++it)
+      {
+        if (it->second.pending)
+          {
+            WriteHandover (it->first, it->second, -1.0);
+          }
+      }
+    m_out.flush ();
+
+    for (std::map<uint64_t, UeState>::const_iterator it = m_ues.begin (); it != m_ues.end (); ++it)
+      {
+        const UeState &s = it->second;
+        os << "UE IMSI " << it->first << " handovers\n";
+        os << " Completed: " << s.handovers << " (failed " << s.failures
+           << ", ping-pong " << s.pingPongs << ", RLF " << s.rlfs << ")\n";
+        os << " Mean Execution: " << (s.handovers ? s.execSumMs / s.handovers : 0.0) << " ms\n";
+        os << " Mean Interruption: " << (s.interruptions ? s.interruptSumMs / s.interruptions : 0.0) << " ms\n";
+        os << " X2 Forwarded Bytes: " << s.x2BytesTotal << "\n";
+      }
+    os << "X2-C Signalling Bytes: " << m_x2cBytes << "\n";
+    os << "X2-U Unattributed Bytes: " << m_x2uUnattributed << "\n";
+  }
+
+  //Accessors used by the end of run summaries
+  uint32_t
+  GetHandoverCount () const
+  {
+    uint32_t n = 0;
+    for (std::map<uint64_t, UeState>::const_iterator it = m_ues.begin (); it != m_ues.end (); ++it)
+      {
+        n += it->second.handovers;
+      }
+    return n;
+  }
+
+  double
+  GetMeanInterruptionMs () const
+  {
+    double sum = 0;
+    uint32_t n = 0;
+    for (std::map<uint64_t, UeState>::const_iterator it = m_ues.begin (); it != m_ues.end (); ++it)
+      {
+        sum += it->second.interruptSumMs;
+        n += it->second.interruptions;
+      }
+    return n ? sum / n : 0.0;
+  }
+
+private:
+  struct UeState
+  {
+    UeState ()
+      : inHandover (false), pending (false), source (0), target (0),
+        prevSource (0), prevTarget (0), pingPong (false), x2Bytes (0),
+        handovers (0), failures (0), pingPongs (0), rlfs (0), interruptions (0),
+        execSumMs (0), interruptSumMs (0), x2BytesTotal (0)
+    {
+    }
+    bool inHandover;      //between HandoverStart and HandoverEndOk/Error
+    bool pending;         //handover complete, waiting for the first packet
+    uint16_t source;
+    uint16_t target;
+    uint16_t prevSource;
+    uint16_t prevTarget;
+    bool pingPong;
+    Time start;
+    Time end;
+    Time prevEnd;
+    Time lastRx;
+    Time lastRxBeforeStart;
+    uint64_t x2Bytes;
+    //totals
+    uint32_t handovers;
+    uint32_t failures;
+    uint32_t pingPongs;
+    uint32_t rlfs;
+    uint32_t interruptions;
+    double execSumMs;
+    double interruptSumMs;
+    uint64_t x2BytesTotal;
+  };
+
+  void
+  HandoverStart (uint64_t imsi, uint16_t cellId, uint16_t rnti, uint16_t targetCellId)
+  {
+    UeState &s = m_ues[imsi];
+    if (s.pending)
+      {
+        //no data arrived between two handovers, the gap is unknown
+        WriteHandover (imsi, s, -1.0);
+      }
+    s.inHandover = true;
+    s.source = cellId;
+    s.target = targetCellId;
+    s.start = Simulator::Now ();
+    s.lastRxBeforeStart = s.lastRx;
+    s.x2Bytes = 0;
+  }
+
+  //The source forwards over X2-U with the TEIDs of the S1-U bearers, which
+  //are never reused, so they stay mapped after its UE context is released
+  void
+  SourceHandoverStart (std::string context, uint64_t imsi, uint16_t cellId, uint16_t rnti, uint16_t targetCellId)
+  {
+    std::ostringstream path;
+    path << context.substr (0, context.rfind ('/')) << "/UeMap/" << rnti << "/DataRadioBearerMap/*";
+    Config::MatchContainer drbs = Config::LookupMatches (path.str ());
+    for (uint32_t d = 0; d < drbs.GetN (); ++d)
+      {
+        m_imsiByTeid[drbs.Get (d)->GetObject<LteDataRadioBearerInfo> ()->m_gtpTeid] = imsi;
+      }
+  }
+
+  void
+  HandoverEndOk (uint64_t imsi, uint16_t cellId, uint16_t rnti)
+  {
+    UeState &s = m_ues[imsi];
+    if (!s.inHandover)
+      {
+        return;
+      }
+    s.inHandover = false;
+    s.pending = true;
+    s.end = Simulator::Now ();
+    s.pingPong = s.prevSource == s.target && s.prevTarget == s.source
+      && s.handovers > 0 && s.start - s.prevEnd <= m_pingPongWindow;
+    s.handovers++;
+    s.execSumMs += (s.end - s.start).GetSeconds () * 1e3;
+    if (s.pingPong)
+      {
+        s.pingPongs++;
+      }
+    s.prevSource = s.source;
+    s.prevTarget = s.target;
+    s.prevEnd = s.end;
+  }
+
+  void
+  HandoverEndError (uint64_t imsi, uint16_t cellId, uint16_t rnti)
+  {
+    UeState &s = m_ues[imsi];
+    s.inHandover = false;
+    s.failures++;
+    WriteEvent (imsi, "HO_FAIL", s.source, s.target);
+  }
+
+  void
+  RadioLinkFailure (uint64_t imsi, uint16_t cellId, uint16_t rnti)
+  {
+    UeState &s = m_ues[imsi];
+    s.rlfs++;
+    WriteEvent (imsi, "RLF", cellId, 0);
+    s.inHandover = false;
+  }
+
+  void
+  UeRx (std::string context)
+  {
+    //context is "/NodeList/<id>/$ns3::Ipv4L3Protocol/Rx"
+    uint32_t nodeId = std::atoi (context.substr (10, context.find ('/', 10) - 10).c_str ());
+    std::map<uint32_t, uint64_t>::const_iterator it = m_imsiByNode.find (nodeId);
+    if (it == m_imsiByNode.end ())
+      {
+        return;
+      }
+    UeState &s = m_ues[it->second];
+    Time now = Simulator::Now ();
+    if (s.pending)
+      {
+        double gapMs = (now - (s.lastRxBeforeStart.IsZero () ? s.start : s.lastRxBeforeStart)).GetSeconds () * 1e3;
+        s.interruptions++;
+        s.interruptSumMs += gapMs;
+        WriteHandover (it->second, s, gapMs);
+      }
+    s.lastRx = now;
+  }
+
+  void
+  UeRxV4 (std::string context, Ptr<const Packet> p, Ptr<Ipv4> ipv4, uint32_t interface)
+  {
+    UeRx (context);
+  }
+
+  void
+  UeRxV6 (std::string context, Ptr<const Packet> p, Ptr<Ipv6> ipv6, uint32_t interface)
+  {
+    UeRx (context);
+  }
+
+  void
+  X2Tx (Ptr<const Packet> packet)
+  {
+    //MacTx sees the frame with its PPP header, 0x0021 is IPv4
+    Ptr<Packet> p = packet->Copy ();
+    PppHeader ppp;
+    Ipv4Header ip;
+    UdpHeader udp;
+    GtpuHeader gtpu;
+    p->RemoveHeader (ppp);
+    if (ppp.GetProtocol () != 0x0021)
+      {
+        return;
+      }
+    p->RemoveHeader (ip);
+    if (ip.GetProtocol () != UdpL4Protocol::PROT_NUMBER)
+      {
+        return;
+      }
+    p->RemoveHeader (udp);
+    if (udp.GetDestinationPort () != X2U_PORT)
+      {
+        m_x2cBytes += packet->GetSize ();
+        return;
+      }
+
+    //Forwarded data is charged to the UE owning the bearer
+    p->RemoveHeader (gtpu);
+    std::map<uint32_t, uint64_t>::const_iterator it = m_imsiByTeid.find (gtpu.GetTeid ());
+    if (it == m_imsiByTeid.end ())
+      {
+        m_x2uUnattributed += packet->GetSize ();
+        return;
+      }
+    UeState &s = m_ues[it->second];
+    s.x2Bytes += packet->GetSize ();
+    s.x2BytesTotal += packet->GetSize ();
+  }
+
+  void
+  WriteHandover (uint64_t imsi, UeState &s, double interruptMs)
+  {
+    m_out << s.end.GetSeconds () << "," << imsi << ",HO," << s.source << "," << s.target << ","
+          << (s.end - s.start).GetSeconds () * 1e3 << ",";
+    if (interruptMs >= 0)
+      {
+        m_out << interruptMs;
+      }
+    m_out << "," << s.x2Bytes << "," << (s.pingPong ? 1 : 0) << "\n";
+    s.pending = false;
+  }
+
+  void
+  WriteEvent (uint64_t imsi, const char *event, uint16_t source, uint16_t target)
+  {
+    m_out << Simulator::Now ().GetSeconds () << "," << imsi << "," << event << ","
+          << source << "," << target << ",,,,\n";
+  }
+
+  std::ofstream m_out;
+  Time m_pingPongWindow;
+  std::map<uint64_t, UeState> m_ues;
+  std::map<uint32_t, uint64_t> m_imsiByNode;
+  std::map<uint32_t, uint64_t> m_imsiByTeid; //S1-U TEID of a bearer handed over -> IMSI
+  uint64_t m_x2cBytes;
+  uint64_t m_x2uUnattributed;
+};
+
+} // namespace ns3
+
+#endif /* HANDOVER_STATS_H */
@@ -0,0 +1,313 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//Where the one way delay of a UE's packets goes, per radio bearer and
+//direction.
+//
+//The LTE stack, which mmWave reuses above the MAC, reports at the
+//receiving end the delay since PDCP and since RLC (bearer-trace.h). So
+//  RLC queue    PDCP delay - RLC delay, buffering and reordering in RLC
+//  MAC/PHY      RLC delay, scheduling, HARQ retransmissions and decoding
+//  backhaul     server to eNB (downlink) or eNB to server (uplink), timed
+//               with a LatencyStampTag added where the packet leaves
+//HARQ retransmissions cannot be told apart from the first transmission
+//with these tags, so they stay in MAC/PHY. Each layer is a histogram of
+//fixed bins, so the cost does not grow with the number of packets.
+
+#ifndef LATENCY_BUDGET_H
+#define LATENCY_BUDGET_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/lte-module.h"
+#include "ns3/histogram.h"
+
+#include "bearer-trace.h"
+#include "flow-metrics.h"
+
+#include <iostream>
+#include <map>
+#include <sstream>
+
+namespace ns3 {
+
+class LatencyStampTag : public Tag
+{
+public:
+  static TypeId
+  GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("ns3::LatencyStampTag")
+      .SetParent<Tag> ()
+      .SetGroupName ("Network")
+      .AddConstructor<LatencyStampTag> ();
+    return tid;
+  }
+
+  LatencyStampTag ()
+  {
+  }
+
+  LatencyStampTag (Time time)
+    : m_time (time)
+  {
+  }
+
+  virtual TypeId
+  GetInstanceTypeId (void) const
+  {
+    return GetTypeId ();
+  }
+
+  virtual uint32_t
+  GetSerializedSize (void) const
+  {
+    return 8;
+  }
+
+  virtual void
+  Serialize (TagBuffer i) const
+  {
+    i.WriteU64 (m_time.GetTimeStep ());
+  }
+
+  virtual void
+  Deserialize (TagBuffer i)
+  {
+    m_time = TimeStep (i.ReadU64 ());
+  }
+
+  virtual void
+  Print (std::ostream &os) const
+  {
+    os << "t=" << m_time;
+  }
+
+  Time
+  GetTime () const
+  {
+    return m_time;
+  }
+
+private:
+  Time m_time;
+};
+
+NS_OBJECT_ENSURE_REGISTERED (LatencyStampTag);
+
+class LatencyBudget
+{
+public:
+  //Histogram bins of 0.1 ms
+  LatencyBudget ()
+    : m_ue (0),
+      m_backhaulDl (1e-4),
+      m_backhaulUl (1e-4)
+  {
+  }
+
+  //Time the bearers of the UE at the eNBs and its traffic with the server.
+  //The bearers only exist once the UE has attached, so they are hooked at
+  //connectAt, before the applications start.
+  void
+  Install (Ptr<Node> ue, NodeContainer enbNodes, Ptr<Node> server, Time connectAt)
+  {
+    m_ue = ue->GetId ();
+    std::ostringstream path;
+    path << "/NodeList/" << server->GetId () << "/$ns3::Ipv4L3Protocol/";
+    Config::ConnectWithoutContext (path.str () + "Tx", MakeCallback (&LatencyBudget::Stamp, this));
+    Config::ConnectWithoutContext (path.str () + "Rx", MakeCallback (&LatencyBudget::BackhaulUl, this));
+    for (uint32_t e = 0; e < enbNodes.GetN (); ++e)
+      {
+        std::ostringstream enb;
+        enb << "/NodeList/" << enbNodes.Get (e)->GetId () << "/$ns3::Ipv4L3Protocol/";
+        Config::ConnectWithoutContext (enb.str () + "Tx", MakeCallback (&LatencyBudget::Stamp, this));
+        Config::ConnectWithoutContext (enb.str () + "Rx", MakeCallback (&LatencyBudget::BackhaulDl, this));
+      }
+    Simulator::Schedule (connectAt, &LatencyBudget::ConnectBearers, this);
+  }
+
+  void
+  Print (std::ostream &os = std::cout) const
+  {
+    os << "Latency budget of the UE (mean / p95)\n";
+    for (std::map<uint64_t, Bearer>::const_iterator it = m_bearers.begin (); it != m_bearers.end (); ++it)
+      {
+        const Bearer &b = it->second;
+        os << " " << (BearerUplink (it->first) ? "UL" : "DL") << " bearer LCID " << BearerLcid (it->first)
+           << ", RNTI " << BearerRnti (it->first) << " at eNB node " << BearerEnbNode (it->first) << "\n";
+        PrintLayer (os, "RLC queue", b.rlcQueue);
+        PrintLayer (os, "MAC/PHY", b.macPhy);
+      }
+    PrintLayer (os, "DL backhaul", m_backhaulDl);
+    PrintLayer (os, "UL backhaul", m_backhaulUl);
+  }
+
+private:
+  struct Layer
+  {
+    Layer (double binWidth)
+      : hist (binWidth), sum (0), n (0)
+    {
+    }
+    void
+    Add (double seconds)
+    {
+      hist.AddValue (seconds);
+      sum += seconds;
+      n++;
+    }
+    Histogram hist;
+    double sum;
+    uint64_t n;
+  };
+
+  struct Bearer
+  {
+    Bearer ()
+      : rlcQueue (1e-4), macPhy (1e-4), lastRlcNs (0)
+    {
+    }
+    Layer rlcQueue;
+    Layer macPhy;
+    uint64_t lastRlcNs;  //MAC/PHY delay of the last PDU, to split the next SDU
+  };
+
+  static void
+  PrintLayer (std::ostream &os, std::string name, const Layer &l)
+  {
+    if (l.n == 0)
+      {
+        return;
+      }
+    os << "  " << name << ": " << 1e3 * SafeRatio (l.sum, l.n) << " / "
+       << 1e3 * HistogramPercentile (l.hist, 0.95) << " ms (" << l.n << " packets)\n";
+  }
+
+  void
+  ConnectBearers ()
+  {
+    std::map<uint16_t, uint32_t> enbByCell = EnbNodeByCell ();
+    std::ostringstream node;
+    node << m_ue;
+    std::vector<std::string> paths = UeRrcPaths (node.str ());
+    for (uint32_t n = 0; n < paths.size (); ++n)
+      {
+        Config::MatchContainer rrcs = Config::LookupMatches (paths[n]);
+        for (uint32_t r = 0; r < rrcs.GetN (); ++r)
+          {
+            Ptr<LteUeRrc> rrc = rrcs.Get (r)->GetObject<LteUeRrc> ();
+            std::map<uint16_t, uint32_t>::const_iterator serving = enbByCell.find (rrc->GetCellId ());
+            if (serving == enbByCell.end ())
+              {
+                continue;
+              }
+            //downlink at the UE, uplink at its context in the serving eNB,
+            //another cell may have given the same RNTI to another UE
+            std::ostringstream enb;
+            enb << "/NodeList/" << serving->second << "/DeviceList/*/LteEnbRrc/UeMap/" << rrc->GetRnti ()
+                << "/DataRadioBearerMap/*/";
+            Config::ConnectWithoutContext (rrcs.GetMatchedPath (r) + "/DataRadioBearerMap/*/LteRlc/RxPDU",
+                                           MakeBoundCallback (&LatencyBudget::RlcRxDl, this, serving->second));
+            Config::ConnectWithoutContext (rrcs.GetMatchedPath (r) + "/DataRadioBearerMap/*/LtePdcp/RxPDU",
+                                           MakeBoundCallback (&LatencyBudget::PdcpRxDl, this, serving->second));
+            Config::ConnectWithoutContext (enb.str () + "LteRlc/RxPDU",
+                                           MakeBoundCallback (&LatencyBudget::RlcRxUl, this, serving->second));
+            Config::ConnectWithoutContext (enb.str () + "LtePdcp/RxPDU",
+                                           MakeBoundCallback (&LatencyBudget::PdcpRxUl, this, serving->second));
+          }
+      }
+  }
+
+  void
+  RlcRx (uint64_t key, uint64_t delayNs)
+  {
+    Bearer &b = m_bearers[key];
+    b.macPhy.Add (delayNs * 1e-9);
+    b.lastRlcNs = delayNs;
+  }
+
+  void
+  PdcpRx (uint64_t key, uint64_t delayNs)
+  {
+    Bearer &b = m_bearers[key];
+    b.rlcQueue.Add (RlcSojourn (delayNs, b.lastRlcNs));
+  }
+
+  static void
+  RlcRxDl (LatencyBudget *budget, uint32_t enbNode, uint16_t rnti, uint8_t lcid, uint32_t size, uint64_t delayNs)
+  {
+    budget->RlcRx (BearerKey (enbNode, false, rnti, lcid), delayNs);
+  }
+
+  static void
+  PdcpRxDl (LatencyBudget *budget, uint32_t enbNode, uint16_t rnti, uint8_t lcid, uint32_t size, uint64_t delayNs)
+  {
+    budget->PdcpRx (BearerKey (enbNode, false, rnti, lcid), delayNs);
+  }
+
+  static void
+  RlcRxUl (LatencyBudget *budget, uint32_t enbNode, uint16_t rnti, uint8_t lcid, uint32_t size, uint64_t delayNs)
+  {
+    budget->RlcRx (BearerKey (enbNode, true, rnti, lcid), delayNs);
+  }
+
+  static void
+  PdcpRxUl (LatencyBudget *budget, uint32_t enbNode, uint16_t rnti, uint8_t lcid, uint32_t size, uint64_t delayNs)
+  {
+    budget->PdcpRx (BearerKey (enbNode, true, rnti, lcid), delayNs);
+  }
+
+  //Packets leaving the server (downlink) or the eNB towards it (uplink)
+  void
+  Stamp (Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface)
+  {
+    LatencyStampTag tag (Simulator::Now ());
+    packet->AddByteTag (tag);
+  }
+
+  void
+  BackhaulDl (Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface)
+  {
+    AddBackhaul (m_backhaulDl, packet);
+  }
+
+  void
+  BackhaulUl (Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface)
+  {
+    AddBackhaul (m_backhaulUl, packet);
+  }
+
+  static void
+  AddBackhaul (Layer &layer, Ptr<const Packet> packet)
+  {
+    LatencyStampTag tag;
+    if (packet->FindFirstMatchingByteTag (tag))
+      {
+        layer.Add ((Simulator::Now () - tag.GetTime ()).GetSeconds ());
+      }
+  }
+
+  uint32_t m_ue;
+  Layer m_backhaulDl;
+  Layer m_backhaulUl;
+  std::map<uint64_t, Bearer> m_bearers; //by BearerKey
+};
+
+} // namespace ns3
+
+#endif /* LATENCY_BUDGET_H */
@@ -0,0 +1,244 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//Per-UE downlink link adaptation, one CSV record per UE and window:
+//  time_s,node,sinrMin,sinrMean,sinrMax,cqiMin,cqiMean,cqiMax,
+//  mcsMin,mcsMean,mcsMax,resMin,resMean,resMax,dlMbps
+//SINR is in dB. On LTE the SINR is the UE's serving cell report, MCS and
+//resources (PRBs) come from every allocation the eNB MAC schedules. On
+//mmWave all of them come from the TBs the UE receives and the resources are
+//OFDM symbols. Neither module traces the CQI the UE reports, so the CQI is
+//the one the AMC table gives for the SINR. Only running min, sum and max
+//are kept, so the cost is one record per window whatever the traffic.
+
+#ifndef LINK_QUALITY_RECORDER_H
+#define LINK_QUALITY_RECORDER_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/lte-module.h"
+#include "ns3/mmwave-phy-mac-common.h"
+
+#include "scheduler-stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+
+namespace ns3 {
+
+class LinkQualityRecorder
+{
+public:
+  //Nothing is recorded until one of the Install methods is called
+  LinkQualityRecorder (std::string filename, Time window)
+    : m_filename (filename),
+      m_window (window),
+      m_maxPrbs (0)
+  {
+  }
+
+  //Hook the serving cell SINR of every LTE UE and the allocations of the eNBs
+  void
+  InstallLte (NetDeviceContainer enbDevs)
+  {
+    Start ();
+    for (uint32_t e = 0; e < enbDevs.GetN (); ++e)
+      {
+        Ptr<LteEnbNetDevice> enb = enbDevs.Get (e)->GetObject<LteEnbNetDevice> ();
+        m_enbByCell[enb->GetCellId ()] = enb->GetNode ()->GetId ();
+        m_maxPrbs = std::max<uint16_t> (m_maxPrbs, enb->GetDlBandwidth ());
+      }
+    Config::Connect ("/NodeList/*/DeviceList/*/ComponentCarrierMapUe/*/LteUePhy/ReportCurrentCellRsrpSinr",
+                     MakeCallback (&LinkQualityRecorder::LteSinr, this));
+    Config::Connect ("/NodeList/*/DeviceList/*/ComponentCarrierMap/*/LteEnbMac/DlScheduling",
+                     MakeCallback (&LinkQualityRecorder::DlScheduling, this));
+  }
+
+  //Hook the TBs every mmWave UE receives
+  void
+  InstallMmWave ()
+  {
+    Start ();
+    Config::Connect ("/NodeList/*/DeviceList/*/ComponentCarrierMapUe/*/MmWaveUePhy/DlSpectrumPhy/RxPacketTraceUe",
+                     MakeCallback (&LinkQualityRecorder::RxPacketTraceUe, this));
+  }
+
+  //Write the last, partial, window
+  void
+  Finish ()
+  {
+    if (!m_out.is_open ())
+      {
+        return;
+      }
+    Write ();
+    m_out.flush ();
+  }
+
+private:
+  struct Stat
+  {
+    Stat ()
+      : n (0), min (0), max (0), sum (0)
+    {
+    }
+    void
+    Add (double x)
+    {
+      min = n ? std::min (min, x) : x;
+      max = n ? std::max (max, x) : x;
+      sum += x;
+      n++;
+    }
+    uint32_t n;
+    double min;
+    double max;
+    double sum;
+  };
+
+  struct Window
+  {
+    Window ()
+      : bytes (0)
+    {
+    }
+    Stat sinr;
+    Stat cqi;
+    Stat mcs;
+    Stat res;
+    uint64_t bytes;
+  };
+
+  void
+  Start ()
+  {
+    NS_ABORT_MSG_IF (m_window <= Time (0), "The link quality window must be positive");
+    m_out.open (m_filename.c_str ());
+    m_out << "time_s,node,sinrMin,sinrMean,sinrMax,cqiMin,cqiMean,cqiMax,"
+          << "mcsMin,mcsMean,mcsMax,resMin,resMean,resMax,dlMbps\n";
+    m_amc = CreateObject<LteAmc> ();
+    m_lastWrite = Simulator::Now ();
+    Simulator::Schedule (m_window, &LinkQualityRecorder::Flush, this);
+  }
+
+  static uint64_t
+  NodeFromContext (std::string context)
+  {
+    return atoi (context.substr (10, context.find ('/', 10) - 10).c_str ());
+  }
+
+  //CQI of the AMC table for a wideband SINR, as in LteAmc::CreateCqiFeedbacks
+  int
+  Cqi (double sinr) const
+  {
+    double gap = -std::log (5.0 * 0.00005) / 1.5;
+    return m_amc->GetCqiFromSpectralEfficiency (std::log (1 + sinr / gap) / std::log (2.0));
+  }
+
+  void
+  AddSinr (uint32_t node, double sinr)
+  {
+    Window &w = m_windows[node];
+    w.sinr.Add (10 * std::log10 (sinr));
+    w.cqi.Add (Cqi (sinr));
+  }
+
+  void
+  LteSinr (std::string context, uint16_t cellId, uint16_t rnti, double rsrp, double sinr, uint8_t componentCarrierId)
+  {
+    uint32_t node = NodeFromContext (context);
+    m_ueByEnbRnti[(static_cast<uint64_t> (m_enbByCell[cellId]) << 16) | rnti] = node;
+    AddSinr (node, sinr);
+  }
+
+  void
+  DlScheduling (std::string context, DlSchedulingCallbackInfo info)
+  {
+    std::map<uint64_t, uint32_t>::const_iterator ue = m_ueByEnbRnti.find ((NodeFromContext (context) << 16) | info.rnti);
+    if (ue == m_ueByEnbRnti.end () || info.sizeTb1 == 0)
+      {
+        return;
+      }
+    Window &w = m_windows[ue->second];
+    w.mcs.Add (info.mcsTb1);
+    w.res.Add (DlPrbsFromTb (m_amc, info.mcsTb1, info.sizeTb1, m_maxPrbs));
+    w.bytes += info.sizeTb1 + info.sizeTb2;
+  }
+
+  void
+  RxPacketTraceUe (std::string context, RxPacketTraceParams params)
+  {
+    uint32_t node = NodeFromContext (context);
+    AddSinr (node, params.m_sinr);
+    Window &w = m_windows[node];
+    w.mcs.Add (params.m_mcs);
+    w.res.Add (params.m_numSym);
+    if (!params.m_corrupt)
+      {
+        w.bytes += params.m_tbSize;
+      }
+  }
+
+  void
+  Flush ()
+  {
+    Write ();
+    Simulator::Schedule (m_window, &LinkQualityRecorder::Flush, this);
+  }
+
+  //The throughput is over the time since the last write, the last window
+  //is partial. A statistic without samples is left empty.
+  void
+  Write ()
+  {
+    double elapsed = (Simulator::Now () - m_lastWrite).GetSeconds ();
+    for (std::map<uint32_t, Window>::const_iterator it = m_windows.begin (); it != m_windows.end (); ++it)
+      {
+        const Window &w = it->second;
+        m_out << Simulator::Now ().GetSeconds () << "," << it->first;
+        const Stat *stats[] = { &w.sinr, &w.cqi, &w.mcs, &w.res };
+        for (uint32_t s = 0; s < 4; ++s)
+          {
+            if (stats[s]->n == 0)
+              {
+                m_out << ",,,";
+                continue;
+              }
+            m_out << "," << stats[s]->min << "," << stats[s]->sum / stats[s]->n << "," << stats[s]->max;
+          }
+        m_out << "," << GoodputMbps (w.bytes, elapsed) << "\n";
+      }
+    m_windows.clear ();
+    m_lastWrite = Simulator::Now ();
+  }
+
+  std::string m_filename;
+  Time m_window;
+  Time m_lastWrite;
+  std::ofstream m_out;
+  Ptr<LteAmc> m_amc;
+  uint16_t m_maxPrbs;
+  std::map<uint16_t, uint32_t> m_enbByCell;    //cell id to eNB node id
+  std::map<uint64_t, uint32_t> m_ueByEnbRnti;  //eNB node id << 16 | rnti to UE node id
+  std::map<uint32_t, Window> m_windows;        //by UE node id
+};
+
+} // namespace ns3
+
+#endif /* LINK_QUALITY_RECORDER_H */
@@ -0,0 +1,456 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//Pedestrian blockage of the mmWave links of walking users.
+//
+//Blockers of the given density walk at random across every link. A link
+//of 2D length d is crossed by (2/pi) * density * speed * (d * f + 2 * radius)
+//blockers per second, f being the share of the link below the blocker
+//height, and each one blocks it for an exponential time with a mean of its
+//diameter over its speed. While blocked the link is NLOS and loses Loss dB
+//on top of the pathloss model it is chained to, as in the 3GPP TR 38.901
+//blockage model. The LOS state of a link is cached with the time of its
+//next change, and the arrival rate is only worked out again when one end
+//changes course, so the state is not recomputed for every transmission.
+//
+//BlockageStats bins the bytes the end hosts receive and, for every
+//blockage of the UE, writes one CSV record
+//  start_s,end_s,durationMs,baselineMbps,minMbps,collapseMs,recoveryMs
+//where collapseMs is the time from the blockage to the first window below
+//half the throughput of the second before it, and recoveryMs the time from
+//the end of the blockage to the first window back at 90 % of it. Both are
+//-1 when the throughput never collapsed or did not recover.
+
+#ifndef MMWAVE_BLOCKAGE_H
+#define MMWAVE_BLOCKAGE_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/mmwave-helper.h"
+
+#include "flow-metrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <vector>
+
+namespace ns3 {
+
+class BlockageLossModel : public PropagationLossModel
+{
+public:
+  static TypeId
+  GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("ns3::BlockageLossModel")
+      .SetParent<PropagationLossModel> ()
+      .SetGroupName ("Propagation")
+      .AddConstructor<BlockageLossModel> ()
+      .AddAttribute ("BlockerDensity", "Blockers per square metre, 0 disables blockage",
+                     DoubleValue (0.0),
+                     MakeDoubleAccessor (&BlockageLossModel::m_density),
+                     MakeDoubleChecker<double> (0.0))
+      .AddAttribute ("BlockerSpeed", "Walking speed of the blockers [m/s]",
+                     DoubleValue (1.0),
+                     MakeDoubleAccessor (&BlockageLossModel::m_speed),
+                     MakeDoubleChecker<double> (0.01))
+      .AddAttribute ("BlockerRadius", "Radius of a blocker [m]",
+                     DoubleValue (0.3),
+                     MakeDoubleAccessor (&BlockageLossModel::m_radius),
+                     MakeDoubleChecker<double> (0.01))
+      .AddAttribute ("BlockerHeight", "Height of a blocker [m]",
+                     DoubleValue (1.7),
+                     MakeDoubleAccessor (&BlockageLossModel::m_height),
+                     MakeDoubleChecker<double> (0.0))
+      .AddAttribute ("Loss", "Extra loss of a blocked link [dB]",
+                     DoubleValue (20.0),
+                     MakeDoubleAccessor (&BlockageLossModel::m_lossDb),
+                     MakeDoubleChecker<double> (0.0))
+      .AddTraceSource ("LosChange", "A link was blocked or cleared, with the time it happened",
+                       MakeTraceSourceAccessor (&BlockageLossModel::m_losChange),
+                       "ns3::BlockageLossModel::LosChangeCallback");
+    return tid;
+  }
+
+  typedef void (*LosChangeCallback) (uint32_t nodeA, uint32_t nodeB, bool los, Time at);
+
+  BlockageLossModel ()
+  {
+    m_rng = CreateObject<ExponentialRandomVariable> ();
+  }
+
+  //Whether the link between the nodes is in line of sight, as last seen
+  bool
+  IsLos (uint32_t nodeA, uint32_t nodeB) const
+  {
+    std::map<std::pair<uint32_t, uint32_t>, Link>::const_iterator it =
+      m_links.find (std::make_pair (std::min (nodeA, nodeB), std::max (nodeA, nodeB)));
+    return it == m_links.end () || it->second.los;
+  }
+
+private:
+  struct Link
+  {
+    bool los;
+    Time next;     //of the next change of state
+    double rate;   //blockers crossing per second
+    uint32_t movesA;
+    uint32_t movesB;
+  };
+
+  virtual double
+  DoCalcRxPower (double txPowerDbm, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const
+  {
+    if (m_density <= 0)
+      {
+        return txPowerDbm;
+      }
+    uint32_t idA = Watch (a);
+    uint32_t idB = Watch (b);
+    std::pair<uint32_t, uint32_t> key = std::make_pair (std::min (idA, idB), std::max (idA, idB));
+    std::map<std::pair<uint32_t, uint32_t>, Link>::iterator it = m_links.find (key);
+    if (it == m_links.end ())
+      {
+        Link link;
+        link.los = true;
+        link.rate = ArrivalRate (a, b);
+        link.next = Simulator::Now () + Draw (link.rate > 0 ? 1.0 / link.rate : 0);
+        link.movesA = m_moves[key.first];
+        link.movesB = m_moves[key.second];
+        it = m_links.insert (std::make_pair (key, link)).first;
+      }
+
+    Link &link = it->second;
+    while (Simulator::Now () >= link.next)
+      {
+        link.los = !link.los;
+        m_losChange (key.first, key.second, link.los, link.next);
+        link.next += Draw (link.los ? (link.rate > 0 ? 1.0 / link.rate : 0) : 2 * m_radius / m_speed);
+      }
+    if (link.los && (link.movesA != m_moves[key.first] || link.movesB != m_moves[key.second]))
+      {
+        //arrivals are memoryless, so the next one can be drawn again at the new rate
+        link.rate = ArrivalRate (a, b);
+        link.next = Simulator::Now () + Draw (link.rate > 0 ? 1.0 / link.rate : 0);
+        link.movesA = m_moves[key.first];
+        link.movesB = m_moves[key.second];
+      }
+    return link.los ? txPowerDbm : txPowerDbm - m_lossDb;
+  }
+
+  virtual int64_t
+  DoAssignStreams (int64_t stream)
+  {
+    m_rng->SetStream (stream);
+    return 1;
+  }
+
+  //Node id of a mobility model, following its course changes
+  uint32_t
+  Watch (Ptr<MobilityModel> mobility) const
+  {
+    Ptr<Node> node = mobility->GetObject<Node> ();
+    NS_ASSERT_MSG (node != 0, "Blockage needs the mobility models aggregated to nodes");
+    if (m_watched.insert (node->GetId ()).second)
+      {
+        mobility->TraceConnectWithoutContext ("CourseChange", MakeCallback (&BlockageLossModel::CourseChange, this));
+      }
+    return node->GetId ();
+  }
+
+  void
+  CourseChange (Ptr<const MobilityModel> mobility) const
+  {
+    m_moves[mobility->GetObject<Node> ()->GetId ()]++;
+  }
+
+  double
+  ArrivalRate (Ptr<MobilityModel> a, Ptr<MobilityModel> b) const
+  {
+    Vector pa = a->GetPosition ();
+    Vector pb = b->GetPosition ();
+    double low = std::min (pa.z, pb.z);
+    double high = std::max (pa.z, pb.z);
+    if (m_height <= low)
+      {
+        return 0;
+      }
+    double below = high > m_height ? (m_height - low) / (high - low) : 1.0;
+    double length = std::sqrt ((pa.x - pb.x) * (pa.x - pb.x) + (pa.y - pb.y) * (pa.y - pb.y));
+    return 2.0 / M_PI * m_density * m_speed * (length * below + 2 * m_radius);
+  }
+
+  //Exponential time of this mean, never when the mean is 0
+  Time
+  Draw (double mean) const
+  {
+    return mean > 0 ? Seconds (m_rng->GetValue (mean, 0)) : Time::Max () - Simulator::Now ();
+  }
+
+  double m_density;
+  double m_speed;
+  double m_radius;
+  double m_height;
+  double m_lossDb;
+  Ptr<ExponentialRandomVariable> m_rng;
+  TracedCallback<uint32_t, uint32_t, bool, Time> m_losChange;
+  mutable std::map<std::pair<uint32_t, uint32_t>, Link> m_links; //lower node id first
+  mutable std::map<uint32_t, uint32_t> m_moves; //course changes per node id
+  mutable std::set<uint32_t> m_watched;
+};
+
+NS_OBJECT_ENSURE_REGISTERED (BlockageLossModel);
+
+//Chain the blockage after the pathloss model of every carrier. Call after
+//the MmWaveHelper has been initialised.
+inline void
+InstallBlockage (Ptr<mmwave::MmWaveHelper> helper, uint16_t numCcs, Ptr<BlockageLossModel> blockage)
+{
+  for (uint16_t cc = 0; cc < numCcs; ++cc)
+    {
+      helper->GetPathLossModel (cc)->SetNext (blockage);
+    }
+}
+
+class BlockageStats
+{
+public:
+  BlockageStats (std::string filename, Time window)
+    : m_window (window)
+  {
+    m_out.open (filename.c_str ());
+    m_out << "start_s,end_s,durationMs,baselineMbps,minMbps,collapseMs,recoveryMs\n";
+  }
+
+  //Follow the blockages between the UE and the eNBs and the bytes the end
+  //hosts receive from start
+  void
+  Install (Ptr<BlockageLossModel> blockage, Ptr<Node> ue, NodeContainer enbNodes,
+           NodeContainer endHosts, Time start)
+  {
+    m_start = start;
+    m_ue = ue->GetId ();
+    for (uint32_t e = 0; e < enbNodes.GetN (); ++e)
+      {
+        m_enbs.insert (enbNodes.Get (e)->GetId ());
+      }
+    blockage->TraceConnectWithoutContext ("LosChange", MakeCallback (&BlockageStats::LosChange, this));
+    for (uint32_t h = 0; h < endHosts.GetN (); ++h)
+      {
+        std::ostringstream path;
+        path << "/NodeList/" << endHosts.Get (h)->GetId ();
+        Config::ConnectWithoutContext (path.str () + "/$ns3::Ipv4L3Protocol/Rx",
+                                       MakeCallback (&BlockageStats::RxV4, this));
+        Config::ConnectWithoutContext (path.str () + "/$ns3::Ipv6L3Protocol/Rx",
+                                       MakeCallback (&BlockageStats::RxV6, this));
+      }
+  }
+
+  //Write the records and print the summary
+  void
+  Finish (std::ostream &os = std::cout)
+  {
+    //the windows with nothing received since the last byte, so a blockage
+    //lasting to the end of the run can still collapse
+    if (Simulator::Now () > m_start && m_bins.size () < Bin (Simulator::Now ()))
+      {
+        m_bins.resize (Bin (Simulator::Now ()), 0);
+      }
+    uint32_t collapses = 0;
+    uint32_t recoveries = 0;
+    double blockedS = 0;
+    double collapseSumMs = 0;
+    double recoverySumMs = 0;
+    for (uint32_t n = 0; n < m_events.size (); ++n)
+      {
+        Time start = m_events[n].first;
+        Time end = m_events[n].second.IsZero () ? Simulator::Now () : m_events[n].second;
+        blockedS += (end - start).GetSeconds ();
+        double collapseMs = -1;
+        double recoveryMs = -1;
+        double minMbps = 0;
+        double baseline = Baseline (start);
+        if (baseline > 0)
+          {
+            //first window below half the baseline during the blockage
+            uint32_t k = Bin (start);
+            minMbps = baseline;
+            for (; k <= Bin (end) && k < m_bins.size (); ++k)
+              {
+                minMbps = std::min (minMbps, BinMbps (k));
+                if (BinMbps (k) < 0.5 * baseline)
+                  {
+                    break;
+                  }
+              }
+            if (k <= Bin (end) && k < m_bins.size ())
+              {
+                collapseMs = std::max (0.0, (BinEnd (k) - start).GetSeconds () * 1e3);
+                collapses++;
+                collapseSumMs += collapseMs;
+                for (k = Bin (end); k < m_bins.size (); ++k)
+                  {
+                    minMbps = std::min (minMbps, BinMbps (k));
+                    if (BinMbps (k) >= 0.9 * baseline)
+                      {
+                        break;
+                      }
+                  }
+                if (k < m_bins.size () && !m_events[n].second.IsZero ())
+                  {
+                    recoveryMs = std::max (0.0, (BinEnd (k) - end).GetSeconds () * 1e3);
+                    recoveries++;
+                    recoverySumMs += recoveryMs;
+                  }
+              }
+          }
+        m_out << start.GetSeconds () << "," << (m_events[n].second.IsZero () ? -1.0 : end.GetSeconds ()) << ","
+              << (end - start).GetSeconds () * 1e3 << "," << baseline << "," << minMbps << ","
+              << collapseMs << "," << recoveryMs << "\n";
+      }
+    m_out.flush ();
+
+    double seconds = (Simulator::Now () - m_start).GetSeconds ();
+    os << "Blockage of the UE\n";
+    os << " Events: " << m_events.size () << " (" << 100 * SafeRatio (blockedS, seconds) << " % of the time NLOS)\n";
+    os << " Throughput Collapses: " << collapses << ", mean " << SafeRatio (collapseSumMs, collapses) << " ms after the blockage\n";
+    os << " Recoveries: " << recoveries << ", mean " << SafeRatio (recoverySumMs, recoveries) << " ms after it cleared\n";
+  }
+
+  //Share of the windows since the first byte with less than thresholdMbps
+  double
+  GetOutage (double thresholdMbps) const
+  {
+    uint32_t first = 0;
+    while (first < m_bins.size () && m_bins[first] == 0)
+      {
+        first++;
+      }
+    uint32_t last = Bin (Simulator::Now ());
+    if (first >= last)
+      {
+        return 0;
+      }
+    uint32_t outage = 0;
+    for (uint32_t k = first; k < last; ++k)
+      {
+        if (k >= m_bins.size () || BinMbps (k) < thresholdMbps)
+          {
+            outage++;
+          }
+      }
+    return static_cast<double> (outage) / (last - first);
+  }
+
+private:
+  void
+  LosChange (uint32_t nodeA, uint32_t nodeB, bool los, Time at)
+  {
+    uint32_t other = nodeA == m_ue ? nodeB : nodeA;
+    if ((nodeA != m_ue && nodeB != m_ue) || m_enbs.find (other) == m_enbs.end () || at < m_start)
+      {
+        return;
+      }
+    if (!los)
+      {
+        m_events.push_back (std::make_pair (at, Time (0)));
+      }
+    else if (!m_events.empty () && m_events.back ().second.IsZero ())
+      {
+        m_events.back ().second = at;
+      }
+  }
+
+  void
+  Rx (uint32_t bytes)
+  {
+    if (Simulator::Now () < m_start)
+      {
+        return;
+      }
+    uint32_t k = Bin (Simulator::Now ());
+    if (k >= m_bins.size ())
+      {
+        m_bins.resize (k + 1, 0);
+      }
+    m_bins[k] += bytes;
+  }
+
+  void
+  RxV4 (Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface)
+  {
+    Rx (packet->GetSize ());
+  }
+
+  void
+  RxV6 (Ptr<const Packet> packet, Ptr<Ipv6> ipv6, uint32_t interface)
+  {
+    Rx (packet->GetSize ());
+  }
+
+  uint32_t
+  Bin (Time t) const
+  {
+    return (t - m_start).GetNanoSeconds () / m_window.GetNanoSeconds ();
+  }
+
+  Time
+  BinEnd (uint32_t k) const
+  {
+    return m_start + m_window * (k + 1);
+  }
+
+  double
+  BinMbps (uint32_t k) const
+  {
+    return GoodputMbps (m_bins[k], m_window.GetSeconds ());
+  }
+
+  //Throughput over the second before t, 0 when there was no traffic
+  double
+  Baseline (Time t) const
+  {
+    uint32_t last = std::min<uint32_t> (Bin (t), m_bins.size ());
+    uint32_t windows = std::max<uint32_t> (1, Seconds (1.0).GetNanoSeconds () / m_window.GetNanoSeconds ());
+    uint32_t first = last > windows ? last - windows : 0;
+    uint64_t bytes = 0;
+    for (uint32_t k = first; k < last; ++k)
+      {
+        bytes += m_bins[k];
+      }
+    return last > first ? GoodputMbps (bytes, (last - first) * m_window.GetSeconds ()) : 0;
+  }
+
+  Time m_window;
+  Time m_start;
+  uint32_t m_ue;
+  std::set<uint32_t> m_enbs;
+  std::ofstream m_out;
+  std::vector<std::pair<Time, Time> > m_events; //start and end, 0 while still blocked
+  std::vector<uint64_t> m_bins; //bytes received per window
+};
+
+} // namespace ns3
+
+#endif /* MMWAVE_BLOCKAGE_H */
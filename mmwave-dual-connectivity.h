@@ -0,0 +1,221 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//Non-standalone 5G: a UE with both an LTE and a mmWave radio, anchored on
+//the LTE eNB, using the multi-connectivity devices of the mmWave module.
+//
+//mode is switch or handover. With switch the UE is dual connected: the LTE
+//eNB keeps the RRC and the PDCP of the bearers and, on the mmWave SINR the
+//UE reports to it, moves the data path between the mmWave eNB (over X2)
+//and its own radio with no handover (fast switching). With handover the UE
+//is connected to one RAT at a time and moves with a hard inter-RAT
+//handover. lteUplink sends the uplink of the bearers over LTE while the
+//downlink stays on mmWave, splitting the bearer by direction.
+//
+//DualConnectivityStats writes every switch of the data path, or in
+//handover mode every handover between the RATs, to one CSV record
+//  time_s,imsi,rat
+//and prints them and the share of the time on LTE.
+
+#ifndef MMWAVE_DUAL_CONNECTIVITY_H
+#define MMWAVE_DUAL_CONNECTIVITY_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/lte-module.h"
+#include "ns3/mmwave-helper.h"
+
+#include "flow-metrics.h"
+
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+
+namespace ns3 {
+
+//Call before the devices are installed. The attributes are looked up
+//fail safe, they differ between releases of the mmWave module.
+inline void
+ConfigureDualConnectivity (std::string mode, double outageThresholdDb, bool lteUplink, double x2DelayMs)
+{
+  NS_ABORT_MSG_IF (mode != "switch" && mode != "handover", "Unknown mode " << mode << ", use switch or handover");
+  //mmWave SINR under which the LTE eNB takes the data path back
+  Config::SetDefaultFailSafe ("ns3::LteEnbRrc::OutageThreshold", DoubleValue (outageThresholdDb));
+  Config::SetDefaultFailSafe ("ns3::McUePdcp::LteUplink", BooleanValue (lteUplink));
+  Config::SetDefaultFailSafe ("ns3::MmWavePointToPointEpcHelper::X2LinkDelay",
+                              TimeValue (MicroSeconds (1e3 * x2DelayMs)));
+}
+
+//Install the UE devices of the mode and attach them to the closest eNBs
+inline NetDeviceContainer
+InstallDualConnectedUes (Ptr<mmwave::MmWaveHelper> helper, std::string mode, NodeContainer ueNodes)
+{
+  return mode == "switch" ? helper->InstallMcUeDevice (ueNodes)
+                          : helper->InstallInterRatHoCapableUeDevice (ueNodes);
+}
+
+inline void
+AttachDualConnectedUes (Ptr<mmwave::MmWaveHelper> helper, std::string mode, NetDeviceContainer ueDevs,
+                        NetDeviceContainer mmWaveEnbDevs, NetDeviceContainer lteEnbDevs)
+{
+  if (mode == "switch")
+    {
+      helper->AttachToClosestEnb (ueDevs, mmWaveEnbDevs, lteEnbDevs);
+    }
+  else
+    {
+      helper->AttachIrToClosestEnb (ueDevs, mmWaveEnbDevs, lteEnbDevs);
+    }
+}
+
+class DualConnectivityStats
+{
+public:
+  DualConnectivityStats (std::string filename)
+    : m_handoverMode (false),
+      m_toLte (0),
+      m_toMmWave (0),
+      m_handovers (0),
+      m_lteS (0)
+  {
+    m_out.open (filename.c_str ());
+    m_out << "time_s,imsi,rat\n";
+  }
+
+  //Follow the data path of every UE from start, on mmWave until told
+  //otherwise. In handover mode the RAT is that of the cell handed over to.
+  void
+  Install (Time start, std::string mode, NetDeviceContainer lteEnbDevs)
+  {
+    m_start = start;
+    m_handoverMode = mode == "handover";
+    for (uint32_t e = 0; e < lteEnbDevs.GetN (); ++e)
+      {
+        m_lteCells.insert (DynamicCast<LteEnbNetDevice> (lteEnbDevs.Get (e))->GetCellId ());
+      }
+    //The switch traces of the LTE eNB are only in the multi-connectivity releases
+    if (LteEnbRrc::GetTypeId ().LookupTraceSourceByName ("SwitchToLte") != 0)
+      {
+        Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/LteEnbRrc/SwitchToLte",
+                                       MakeCallback (&DualConnectivityStats::SwitchToLte, this));
+        Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/LteEnbRrc/SwitchToMmWave",
+                                       MakeCallback (&DualConnectivityStats::SwitchToMmWave, this));
+      }
+    Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/LteUeRrc/HandoverEndOk",
+                                   MakeCallback (&DualConnectivityStats::HandoverEndOk, this));
+  }
+
+  void
+  Print (std::ostream &os = std::cout)
+  {
+    Time now = Simulator::Now ();
+    double lteS = m_lteS;
+    for (std::map<uint64_t, Time>::iterator it = m_onLte.begin (); it != m_onLte.end (); ++it)
+      {
+        lteS += (now - it->second).GetSeconds ();
+      }
+    m_out.flush ();
+    os << "Dual connectivity\n";
+    os << (m_handoverMode ? " Handovers to LTE: " : " Switches to LTE: ") << m_toLte
+       << ", back to mmWave: " << m_toMmWave << "\n";
+    os << " Inter-RAT and mmWave handovers: " << m_handovers << "\n";
+    os << " Time on LTE: " << 100 * SafeRatio (lteS, (now - m_start).GetSeconds ()) << " %\n";
+  }
+
+private:
+  //The UE is followed before start too, only its time from start counts
+  void
+  ToLte (uint64_t imsi)
+  {
+    if (m_onLte.find (imsi) != m_onLte.end ())
+      {
+        return;
+      }
+    m_onLte[imsi] = Max (Simulator::Now (), m_start);
+    if (Simulator::Now () >= m_start)
+      {
+        m_toLte++;
+        m_out << Simulator::Now ().GetSeconds () << "," << imsi << ",lte\n";
+      }
+  }
+
+  void
+  ToMmWave (uint64_t imsi)
+  {
+    std::map<uint64_t, Time>::iterator it = m_onLte.find (imsi);
+    if (it == m_onLte.end ())
+      {
+        return;
+      }
+    if (Simulator::Now () >= m_start)
+      {
+        m_toMmWave++;
+        m_lteS += (Simulator::Now () - it->second).GetSeconds ();
+        m_out << Simulator::Now ().GetSeconds () << "," << imsi << ",mmwave\n";
+      }
+    m_onLte.erase (it);
+  }
+
+  void
+  SwitchToLte (uint64_t imsi, uint16_t cellId, uint16_t rnti)
+  {
+    ToLte (imsi);
+  }
+
+  void
+  SwitchToMmWave (uint64_t imsi, uint16_t cellId, uint16_t rnti)
+  {
+    ToMmWave (imsi);
+  }
+
+  //cellId is the target. Only without dual connectivity does the UE
+  //change RAT on a handover, otherwise the LTE RRC stays on LTE.
+  void
+  HandoverEndOk (uint64_t imsi, uint16_t cellId, uint16_t rnti)
+  {
+    if (Simulator::Now () >= m_start)
+      {
+        m_handovers++;
+      }
+    if (!m_handoverMode)
+      {
+        return;
+      }
+    if (m_lteCells.count (cellId) > 0)
+      {
+        ToLte (imsi);
+      }
+    else
+      {
+        ToMmWave (imsi);
+      }
+  }
+
+  Time m_start;
+  bool m_handoverMode;
+  std::set<uint16_t> m_lteCells;
+  uint32_t m_toLte;
+  uint32_t m_toMmWave;
+  uint32_t m_handovers;
+  double m_lteS; //closed periods on LTE
+  std::map<uint64_t, Time> m_onLte; //UEs on LTE and since when
+  std::ofstream m_out;
+};
+
+} // namespace ns3
+
+#endif /* MMWAVE_DUAL_CONNECTIVITY_H */
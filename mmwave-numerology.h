@@ -0,0 +1,161 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//PHY/MAC numerology of the mmWave scenarios (MmWavePhyMacCommon).
+//
+//The subcarrier spacing is the chunk width over its 48 subcarriers and the
+//OFDM symbol period is the subframe period over its symbols. A combination
+//is only accepted when the symbol is long enough for one subcarrier period
+//plus a cyclic prefix of at most a quarter of it, the carrier fits inside
+//10 % of its centre frequency and the frequency is in the 6-100 GHz range
+//of the channel model. The defaults are the module defaults: 28 GHz, 24
+//symbols in a 100us subframe and 72 chunks of 13.889 MHz (1 GHz).
+
+#ifndef MMWAVE_NUMEROLOGY_H
+#define MMWAVE_NUMEROLOGY_H
+
+#include "ns3/core-module.h"
+#include "ns3/mmwave-phy-mac-common.h"
+#include "ns3/mmwave-amc.h"
+
+#include "sweep-file.h"
+
+#include <fstream>
+#include <sstream>
+
+namespace ns3 {
+
+struct MmWaveNumerology
+{
+  static const uint32_t SUBCARRIERS_PER_CHUNK = 48;
+
+  double centreFreqHz;
+  uint32_t symbolsPerSubframe;
+  double subframePeriodUs;
+  uint32_t chunkPerRb;
+  uint32_t rbNum;
+  double chunkWidthHz;
+
+  double
+  BandwidthHz () const
+  {
+    return chunkWidthHz * chunkPerRb * rbNum;
+  }
+
+  double
+  SubcarrierSpacingHz () const
+  {
+    return chunkWidthHz / SUBCARRIERS_PER_CHUNK;
+  }
+
+  double
+  SymbolPeriodUs () const
+  {
+    return subframePeriodUs / symbolsPerSubframe;
+  }
+
+  //Share of the symbol spent on the cyclic prefix, over the useful part
+  double
+  CyclicPrefixRatio () const
+  {
+    return SymbolPeriodUs () * 1e-6 * SubcarrierSpacingHz () - 1.0;
+  }
+};
+
+inline MmWaveNumerology
+DefaultMmWaveNumerology ()
+{
+  MmWaveNumerology n = { 28e9, 24, 100.0, 72, 1, 13.889e6 };
+  return n;
+}
+
+//Empty when the combination is consistent, otherwise why it is not
+inline std::string
+ValidateMmWaveNumerology (const MmWaveNumerology &n)
+{
+  std::ostringstream why;
+  if (n.centreFreqHz < 6e9 || n.centreFreqHz > 100e9)
+    {
+      why << "centre frequency " << n.centreFreqHz / 1e9 << " GHz is outside 6-100 GHz";
+    }
+  else if (n.symbolsPerSubframe < 2 || n.chunkPerRb < 1 || n.rbNum < 1 || n.subframePeriodUs <= 0 || n.chunkWidthHz <= 0)
+    {
+      why << "a subframe needs at least 2 symbols and a carrier at least one chunk";
+    }
+  else if (n.CyclicPrefixRatio () < 0)
+    {
+      why << "symbol of " << n.SymbolPeriodUs () << " us is shorter than the "
+          << 1e6 / n.SubcarrierSpacingHz () << " us of a " << n.SubcarrierSpacingHz () / 1e3 << " kHz subcarrier";
+    }
+  else if (n.CyclicPrefixRatio () > 0.25)
+    {
+      why << "cyclic prefix of " << 100 * n.CyclicPrefixRatio () << " % is over 25 % of the symbol";
+    }
+  else if (n.BandwidthHz () > 0.1 * n.centreFreqHz)
+    {
+      why << "bandwidth of " << n.BandwidthHz () / 1e6 << " MHz is over 10 % of the centre frequency";
+    }
+  return why.str ();
+}
+
+//Downlink peak rate [Mbps] of one carrier, the top MCS on every data symbol
+//of each subframe (the control symbols excluded), like LtePeakDlMbps
+inline double
+MmWavePeakDlMbps (const MmWaveNumerology &n)
+{
+  Ptr<mmwave::MmWavePhyMacCommon> common = CreateObjectWithAttributes<mmwave::MmWavePhyMacCommon> (
+      "SymbolsPerSubframe", UintegerValue (n.symbolsPerSubframe),
+      "ChunkPerRB", UintegerValue (n.chunkPerRb),
+      "ResourceBlockNum", UintegerValue (n.rbNum));
+  Ptr<mmwave::MmWaveAmc> amc = CreateObject<mmwave::MmWaveAmc> (common);
+  uint32_t ctrl = common->GetDlCtrlSymbols () + common->GetUlCtrlSymbols ();
+  uint32_t data = n.symbolsPerSubframe > ctrl ? n.symbolsPerSubframe - ctrl : 0;
+  //TB size in bits per subframe over microseconds
+  return amc->GetTbSizeFromMcsSymbols (28, data) / n.subframePeriodUs;
+}
+
+//Set the MmWavePhyMacCommon defaults, before the MmWaveHelper is created
+inline void
+ConfigureMmWaveNumerology (const MmWaveNumerology &n)
+{
+  std::string why = ValidateMmWaveNumerology (n);
+  NS_ABORT_MSG_IF (!why.empty (), "Inconsistent mmWave numerology: " << why);
+  Config::SetDefault ("ns3::MmWavePhyMacCommon::CenterFreq", DoubleValue (n.centreFreqHz));
+  Config::SetDefault ("ns3::MmWavePhyMacCommon::SymbolsPerSubframe", UintegerValue (n.symbolsPerSubframe));
+  Config::SetDefault ("ns3::MmWavePhyMacCommon::SubframePeriod", DoubleValue (n.subframePeriodUs));
+  Config::SetDefault ("ns3::MmWavePhyMacCommon::SymbolPeriod", DoubleValue (n.SymbolPeriodUs ()));
+  Config::SetDefault ("ns3::MmWavePhyMacCommon::ChunkPerRB", UintegerValue (n.chunkPerRb));
+  Config::SetDefault ("ns3::MmWavePhyMacCommon::ResourceBlockNum", UintegerValue (n.rbNum));
+  Config::SetDefault ("ns3::MmWavePhyMacCommon::ChunkWidth", DoubleValue (n.chunkWidthHz));
+}
+
+//Append one line per run to a sweep CSV, see sweep-file.h
+inline void
+AppendNumerologySweep (std::string filename, const MmWaveNumerology &n,
+                       double goodputMbps, double meanDelayMs, double p95DelayMs, int64_t wallMs)
+{
+  std::ofstream sweep;
+  OpenSweepFile (sweep, filename, "centreFreq_GHz,symbolsPerSubframe,subframePeriod_us,chunkPerRb,rbNum,chunkWidth_MHz,"
+                 "bandwidth_MHz,scs_kHz,goodputMbps,meanDelayMs,p95DelayMs,wallMs");
+  sweep << n.centreFreqHz / 1e9 << "," << n.symbolsPerSubframe << "," << n.subframePeriodUs << ","
+        << n.chunkPerRb << "," << n.rbNum << "," << n.chunkWidthHz / 1e6 << ","
+        << n.BandwidthHz () / 1e6 << "," << n.SubcarrierSpacingHz () / 1e3 << ","
+        << goodputMbps << "," << meanDelayMs << "," << p95DelayMs << "," << wallMs << "\n";
+}
+
+} // namespace ns3
+
+#endif /* MMWAVE_NUMEROLOGY_H */
@@ -0,0 +1,244 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//DRX and RRC release over mmWave: small UDP exchanges seconds apart, started
+//by the server (a push or an incoming call, DL) or by the UE (a page
+//request, UL), so the first packet of each finds the radio asleep. Reports
+//the wake-up latency the DRX and RRC timers add to the first packet and
+//the energy they save over an always connected UE, to compare with
+//DrxLatency.
+
+//Import libraries
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/config-store.h"
+#include <ns3/buildings-helper.h>
+#include "ns3/internet-stack-helper.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/applications-module.h"
+#include "ns3/energy-module.h"
+#include "ns3/flow-monitor-helper.h"
+#include "ns3/ipv4-flow-classifier.h"
+#include "ns3/mmwave-helper.h"
+#include "ns3/mmwave-point-to-point-epc-helper.h"
+
+#include "flow-metrics.h"
+#include "ue-energy-model.h"
+#include "epc-topology.h"
+#include "mmwave-numerology.h"
+#include "responsiveness.h"
+
+//Define namespace
+using namespace ns3;
+using namespace mmwave;
+
+NS_LOG_COMPONENT_DEFINE ("mmwaveDrxLatency");
+
+//Checking for lost packets as part of the Flow Monitor
+ void
+ FlowMonitor::CheckForLostPackets (Time maxDelay)
+ {
+   NS_LOG_FUNCTION (this << maxDelay.GetSeconds ());
+   Time now = Simulator::Now ();
+
+   for (TrackedPacketMap::iterator iter = m_trackedPackets.begin ();
+        iter != m_trackedPackets.end (); )
+     {
+       if (now - iter->second.lastSeenTime >= maxDelay)
+         {
+           // packet is considered lost, add it to the loss statistics
+           FlowStatsContainerI flow = m_flowStats.find (iter->first.first);
+           NS_ASSERT (flow != m_flowStats.end ());
+           flow->second.lostPackets++;
+
+           // we won't track it anymore
+           m_trackedPackets.erase (iter++);
+         }
+       else
+         {
+           iter++;
+         }
+     }
+ }
+
+//Main function
+int main (int argc, char *argv[])
+{
+  //Defaults if none given at runtime
+  double simTime = 120.0;
+  double distance = 50.0; //of the UE from the eNB [m]
+  std::string direction = "dl"; //which end starts the exchanges: dl (the server), ul (the UE) or both
+  double probeGap = 5.0; //mean time between exchanges [s]
+  uint32_t probeSize = 64; //bytes of UDP payload
+  DrxConfig drx = DefaultDrxConfig (); //100ms inactivity, 20 x 20ms short and 40ms long cycles, release after 11.5s
+  MmWaveNumerology numerology = DefaultMmWaveNumerology (); //28GHz, 1GHz in 72 chunks, 24 symbols per 100us
+
+  //Command line arguments, overrides defaults if given
+  CommandLine cmd;
+  cmd.AddValue ("simTime", "Total duration of the simulation", simTime);
+  cmd.AddValue ("distance", "Distance of the UE from the eNB [m]", distance);
+  cmd.AddValue ("direction", "Which end starts the exchanges: dl (the server), ul (the UE) or both", direction);
+  cmd.AddValue ("probeGap", "Mean time between exchanges, exponentially distributed [s]", probeGap);
+  cmd.AddValue ("probeSize", "UDP payload of a probe [bytes]", probeSize);
+  cmd.AddValue ("enableDrx", "Whether the UE uses connected mode DRX", drx.enableDrx);
+  cmd.AddValue ("drxInactivity", "Continuous reception after the last packet [ms]", drx.inactivityMs);
+  cmd.AddValue ("drxOnDuration", "On duration of every DRX cycle [ms]", drx.onDurationMs);
+  cmd.AddValue ("shortDrxCycle", "Short DRX cycle [ms]", drx.shortCycleMs);
+  cmd.AddValue ("shortDrxCycles", "Short DRX cycles before long DRX", drx.shortCycles);
+  cmd.AddValue ("longDrxCycle", "Long DRX cycle [ms]", drx.longCycleMs);
+  cmd.AddValue ("rrcInactivity", "Time without traffic before RRC release [s]", drx.rrcInactivityS);
+  cmd.AddValue ("pagingCycle", "RRC_IDLE paging cycle [ms]", drx.pagingCycleMs);
+  cmd.AddValue ("promotionTime", "RRC_IDLE to RRC_CONNECTED promotion [ms]", drx.promotionMs);
+  cmd.AddValue ("centreFreq", "Carrier centre frequency [Hz]", numerology.centreFreqHz);
+  cmd.AddValue ("symbolsPerSubframe", "OFDM symbols per subframe", numerology.symbolsPerSubframe);
+  cmd.AddValue ("subframePeriod", "Subframe period [us]", numerology.subframePeriodUs);
+  cmd.AddValue ("chunkPerRb", "Chunks per resource block", numerology.chunkPerRb);
+  cmd.AddValue ("rbNum", "Resource blocks of the carrier", numerology.rbNum);
+  cmd.AddValue ("chunkWidth", "Width of a chunk of 48 subcarriers [Hz]", numerology.chunkWidthHz);
+  cmd.Parse (argc, argv);
+
+  LogComponentEnable ("mmwaveDrxLatency", LOG_INFO);
+
+  //Which ends start the exchanges, aborts on an unknown direction
+  TrafficDirection trafficDirection = ParseDirection (direction);
+  NS_ABORT_MSG_IF (probeGap <= 0 || simTime <= 2.0, "The exchanges need a positive gap and time to run");
+  //DRX and RRC timers of the UE radio, aborts on inconsistent cycles
+  ConfigureDrx (drx);
+  //PHY/MAC numerology, aborts on an inconsistent combination
+  ConfigureMmWaveNumerology (numerology);
+
+  //Creating the mmwavehelper object
+  Ptr<MmWaveHelper> ptr_mmWave = CreateObject<MmWaveHelper> ();
+  //The server is a remote host behind the PGW, so the traffic crosses the bearers
+  Ptr<MmWavePointToPointEpcHelper> epcHelper = CreateObject<MmWavePointToPointEpcHelper> ();
+  ptr_mmWave->SetEpcHelper (epcHelper);
+
+  //and then initialising it
+  ptr_mmWave->Initialize ();
+
+  // Create Nodes: 1 eNodeB, 1 UE and 1 server
+  NodeContainer enbNodes;
+  NodeContainer clientServerNodes;
+  enbNodes.Create (1);
+  clientServerNodes.Create (2);
+
+  // Install Mobility Model
+  MobilityHelper mobility;
+    //set non moving enb and ue nodes
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (enbNodes);
+  mobility.Install (clientServerNodes.Get (0));
+  clientServerNodes.Get (0)->GetObject<MobilityModel> ()->SetPosition (Vector (distance, 0.0, 0.0));
+  BuildingsHelper::Install (enbNodes);
+  BuildingsHelper::Install (clientServerNodes.Get (0));
+
+  // Create Devices and install them in the Nodes (eNB and UE)
+  NetDeviceContainer enbDevs = ptr_mmWave->InstallEnbDevice (enbNodes);
+  NetDeviceContainer ueDevs = ptr_mmWave->InstallUeDevice (clientServerNodes.Get (0));
+
+  //Create P2P link between the PGW and the server
+  PointToPointHelper pointToPoint;
+  //Set P2P attributes
+  pointToPoint.SetDeviceAttribute ("DataRate", StringValue ("10Gbps"));
+  pointToPoint.SetChannelAttribute ("Delay", StringValue ("5ms"));
+
+  //Use the internet stack helper and install on the ue and server nodes
+  InternetStackHelper internet;
+  internet.Install (clientServerNodes);
+
+  //Assigning IP addresses, the server gets one on the PGW link and the UE one from the EPC
+  Address serverAddress = ConnectRemoteHost (epcHelper, clientServerNodes.Get (1), pointToPoint, false);
+  std::vector<Address> ueAddresses = AssignUeAddresses (epcHelper, NodeContainer (clientServerNodes.Get (0)), ueDevs, false);
+
+  // Attach a UE to a eNB once it has an address, the EPC sets up the default bearer
+  ptr_mmWave->AttachToClosestEnb (ueDevs, enbDevs.Get (0));
+
+  // Exchanges from 2s, the server probes an echo server on the UE for DL and the UE the server for UL
+  ResponsivenessProbe dlProbe ("DlProbesmmwaveDrxLatency.csv", Seconds (probeGap), probeSize, Time::Max ());
+  ResponsivenessProbe ulProbe ("UlProbesmmwaveDrxLatency.csv", Seconds (probeGap), probeSize, Time::Max ());
+  if (trafficDirection.dl)
+    {
+      dlProbe.SetExponentialGaps ();
+      dlProbe.Install (clientServerNodes.Get (1), clientServerNodes.Get (0), ueAddresses[0], 50001, Seconds (2.0), Seconds (simTime));
+    }
+  if (trafficDirection.ul)
+    {
+      ulProbe.SetExponentialGaps ();
+      ulProbe.Install (clientServerNodes.Get (0), clientServerNodes.Get (1), serverAddress, 50002, Seconds (2.0), Seconds (simTime));
+    }
+
+   //UE battery, 3000 mAh and 3.7V is average mobile phone
+   LiIonEnergySourceHelper liIonSourceHelper;
+   liIonSourceHelper.Set ("LiIonEnergySourceInitialEnergyJ", DoubleValue (35000.00));
+   liIonSourceHelper.Set ("InitialCellVoltage", DoubleValue (3.7));
+   //the radio model updates the source on every RRC/DRX state change, no polling needed
+   liIonSourceHelper.Set ("PeriodicEnergyUpdateInterval", TimeValue (Seconds (simTime)));
+   EnergySourceContainer sources = liIonSourceHelper.Install (clientServerNodes.Get (0));
+   Ptr<UeRadioEnergyModel> ueEnergy = InstallUeRadioEnergyModel (clientServerNodes.Get (0), sources.Get (0));
+
+// Flow monitor
+Ptr<FlowMonitor> flowMonitor;
+FlowMonitorHelper flowHelper;
+flowMonitor = flowHelper.Install (clientServerNodes); //end hosts only, the EPC nodes would report the GTP tunnels
+//Specifying histogram bin widths for delay, jitter and packet size
+flowMonitor->SetAttribute("DelayBinWidth", DoubleValue(0.001));
+flowMonitor->SetAttribute("JitterBinWidth", DoubleValue(0.001));
+flowMonitor->SetAttribute("PacketSizeBinWidth", DoubleValue(20));
+
+//Running and Stopping simulation
+  Simulator::Stop (Seconds (simTime));
+  Simulator::Run ();
+
+//Callback to class, checks for packets that appear to be lost
+flowMonitor->CheckForLostPackets();
+
+//Print the exchanges, then the radio energy and the wake-ups, and the RTT and wake-up of each direction
+PrintFlowMetrics (flowMonitor, flowHelper);
+if (trafficDirection.dl)
+  {
+    dlProbe.Print (std::cout, "Exchanges started by the server (DL first)");
+  }
+if (trafficDirection.ul)
+  {
+    ulProbe.Print (std::cout, "Exchanges started by the UE (UL first)");
+  }
+PrintUeEnergy (flowMonitor, flowHelper, ueEnergy);
+//The stack has no DRX, so the RTT of the exchanges does not include the
+//wake-up the model accounts, and the two are given side by side rather
+//than added. Only the packet starting an exchange finds the radio asleep:
+//the promotion from RRC_IDLE is charged to a DL or UL start alike, the
+//echo reply to a UL start comes back while the radio is ACTIVE and adds
+//nothing.
+for (uint32_t d = 0; d < 2; ++d)
+  {
+    bool downlink = d == 0;
+    if (downlink ? trafficDirection.dl : trafficDirection.ul)
+      {
+        const ResponsivenessProbe &probe = downlink ? dlProbe : ulProbe;
+        std::cout << (downlink ? "DL" : "UL") << " started exchanges: RTT p50 " << 1e3 * probe.GetRtt (false, 0.5)
+                  << " / p95 " << 1e3 * probe.GetRtt (false, 0.95) << " ms, wake-up of the first packet p50 "
+                  << 1e3 * ueEnergy->GetWakeupLatency (downlink, 0.5) << " / p95 "
+                  << 1e3 * ueEnergy->GetWakeupLatency (downlink, 0.95) << " ms\n";
+      }
+  }
+
+//Flow monitor file generation
+flowMonitor->SerializeToXmlFile("FlowMonitormmwaveDrxLatency.xml", true, true); //histograms and probes enabled
+
+  Simulator::Destroy ();
+  return 0;
+}
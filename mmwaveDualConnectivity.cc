@@ -0,0 +1,245 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//Non-standalone 5G: a UE walking at random between an LTE eNB and a mmWave
+//eNB, dual connected (--mode=switch) or moving between them with inter-RAT
+//handovers (--mode=handover). Pedestrians block the mmWave link, not the
+//LTE one. A constant rate UDP download shows the throughput the UE keeps
+//and the share of the time it is in outage while the mmWave link is blocked.
+
+//Import libraries
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/lte-module.h"
+#include "ns3/config-store.h"
+#include <ns3/buildings-helper.h>
+#include "ns3/internet-stack-helper.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/applications-module.h"
+#include "ns3/flow-monitor-helper.h"
+#include "ns3/ipv4-flow-classifier.h"
+#include "ns3/mmwave-helper.h"
+#include "ns3/mmwave-point-to-point-epc-helper.h"
+
+#include "flow-metrics.h"
+#include "epc-topology.h"
+#include "mmwave-numerology.h"
+#include "mmwave-blockage.h"
+#include "mmwave-dual-connectivity.h"
+
+//Define namespace
+using namespace ns3;
+using namespace mmwave;
+
+NS_LOG_COMPONENT_DEFINE ("mmwaveDualConnectivity");
+
+//Checking for lost packets as part of the Flow Monitor
+ void
+ FlowMonitor::CheckForLostPackets (Time maxDelay)
+ {
+   NS_LOG_FUNCTION (this << maxDelay.GetSeconds ());
+   Time now = Simulator::Now ();
+
+   for (TrackedPacketMap::iterator iter = m_trackedPackets.begin ();
+        iter != m_trackedPackets.end (); )
+     {
+       if (now - iter->second.lastSeenTime >= maxDelay)
+         {
+           // packet is considered lost, add it to the loss statistics
+           FlowStatsContainerI flow = m_flowStats.find (iter->first.first);
+           NS_ASSERT (flow != m_flowStats.end ());
+           flow->second.lostPackets++;
+
+           // we won't track it anymore
+           m_trackedPackets.erase (iter++);
+         }
+       else
+         {
+           iter++;
+         }
+     }
+ }
+
+//Main function
+int main (int argc, char *argv[])
+{
+  //Defaults if none given at runtime
+  double simTime = 30.0;
+  std::string mode = "switch"; //dual connected fast switching, or hard inter-RAT handover
+  bool lteUplink = false; //uplink of the bearers over LTE
+  double outageThreshold = -5.0; //mmWave SINR the LTE eNB switches to LTE under [dB]
+  double x2Delay = 1.0; //between the LTE and the mmWave eNB [ms]
+  double lteDistance = 50.0; //of the LTE eNB from the mmWave eNB [m]
+  double dlRate = 50.0; //of the UDP download [Mbps]
+  double outageRate = 1.0; //throughput a window must reach not to count as outage [Mbps]
+  MmWaveNumerology numerology = DefaultMmWaveNumerology (); //28GHz, 1GHz in 72 chunks, 24 symbols per 100us
+  double blockerDensity = 0.01; //pedestrians per square metre that can cross the UE-eNB path
+  double blockerSpeed = 1.0;
+  double blockageLoss = 30.0; //dB on a blocked link
+
+  //Command line arguments, overrides defaults if given
+  CommandLine cmd;
+  cmd.AddValue ("simTime", "Total duration of the simulation", simTime);
+  cmd.AddValue ("mode", "switch (dual connectivity with fast switching) or handover (hard inter-RAT handover)", mode);
+  cmd.AddValue ("lteUplink", "Whether the uplink of the bearers goes over LTE", lteUplink);
+  cmd.AddValue ("outageThreshold", "mmWave SINR under which the data path moves to LTE [dB]", outageThreshold);
+  cmd.AddValue ("x2Delay", "Delay of the X2 link between the LTE and the mmWave eNB [ms]", x2Delay);
+  cmd.AddValue ("lteDistance", "Distance of the LTE eNB from the mmWave eNB [m]", lteDistance);
+  cmd.AddValue ("dlRate", "Rate of the UDP download [Mbps]", dlRate);
+  cmd.AddValue ("outageRate", "Throughput under which a 50 ms window counts as outage [Mbps]", outageRate);
+  cmd.AddValue ("centreFreq", "Carrier centre frequency [Hz]", numerology.centreFreqHz);
+  cmd.AddValue ("symbolsPerSubframe", "OFDM symbols per subframe", numerology.symbolsPerSubframe);
+  cmd.AddValue ("subframePeriod", "Subframe period [us]", numerology.subframePeriodUs);
+  cmd.AddValue ("chunkPerRb", "Chunks per resource block", numerology.chunkPerRb);
+  cmd.AddValue ("rbNum", "Resource blocks of the carrier", numerology.rbNum);
+  cmd.AddValue ("chunkWidth", "Width of a chunk of 48 subcarriers [Hz]", numerology.chunkWidthHz);
+  cmd.AddValue ("blockerDensity", "Pedestrians per square metre that can block the UE, 0 disables blockage", blockerDensity);
+  cmd.AddValue ("blockerSpeed", "Walking speed of the pedestrians [m/s]", blockerSpeed);
+  cmd.AddValue ("blockageLoss", "Extra loss of a blocked link [dB]", blockageLoss);
+  cmd.Parse (argc, argv);
+
+  LogComponentEnable ("mmwaveDualConnectivity", LOG_INFO);
+
+  NS_ABORT_MSG_IF (dlRate <= 0, "The download rate must be positive");
+
+  //PHY/MAC numerology, aborts on an inconsistent combination
+  ConfigureMmWaveNumerology (numerology);
+  //Multi-connectivity attributes, before any device exists
+  ConfigureDualConnectivity (mode, outageThreshold, lteUplink, x2Delay);
+
+  //Creating the mmwavehelper object
+  Ptr<MmWaveHelper> ptr_mmWave = CreateObject<MmWaveHelper> ();
+  //The server is a remote host behind the PGW, the LTE eNB anchors the bearers
+  Ptr<MmWavePointToPointEpcHelper> epcHelper = CreateObject<MmWavePointToPointEpcHelper> ();
+  ptr_mmWave->SetEpcHelper (epcHelper);
+
+  //and then initialising it
+  ptr_mmWave->Initialize ();
+
+  //Pedestrians walking across the mmWave link, the LTE channel has its own pathloss model
+  Ptr<BlockageLossModel> blockage = CreateObject<BlockageLossModel> ();
+  blockage->SetAttribute ("BlockerDensity", DoubleValue (blockerDensity));
+  blockage->SetAttribute ("BlockerSpeed", DoubleValue (blockerSpeed));
+  blockage->SetAttribute ("Loss", DoubleValue (blockageLoss));
+  InstallBlockage (ptr_mmWave, 1, blockage);
+
+  // Create Nodes: 1 LTE eNodeB, 1 mmWave eNodeB, 1 UE and 1 server
+  NodeContainer lteEnbNodes;
+  NodeContainer mmWaveEnbNodes;
+  NodeContainer clientServerNodes;
+  lteEnbNodes.Create (1);
+  mmWaveEnbNodes.Create (1);
+  clientServerNodes.Create (2);
+
+  // Install Mobility Model
+  MobilityHelper mobility;
+    //set non moving enb nodes, the mmWave one in the middle of the walk
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (lteEnbNodes);
+  mobility.Install (mmWaveEnbNodes);
+  lteEnbNodes.Get (0)->GetObject<MobilityModel> ()->SetPosition (Vector (lteDistance, 0.0, 0.0));
+  BuildingsHelper::Install (lteEnbNodes);
+  BuildingsHelper::Install (mmWaveEnbNodes);
+    //set randomly walking ue nodes
+  mobility.SetPositionAllocator ("ns3::GridPositionAllocator",
+    "MinX", DoubleValue (1.0),
+    "MinY", DoubleValue (1.0),
+    "DeltaX", DoubleValue (5.0),
+    "DeltaY", DoubleValue (5.0),
+    "GridWidth", UintegerValue (3),
+    "LayoutType", StringValue ("RowFirst"));
+  mobility.SetMobilityModel ("ns3::RandomWalk2dMobilityModel",
+    "Mode", StringValue ("Time"), //time or distance mode
+    "Time", StringValue ("2s"), //change current direction and speed after this delay
+    "Speed", StringValue ("ns3::ConstantRandomVariable[Constant=1.0]"), //set constant speed of walk
+    "Bounds", RectangleValue (Rectangle (-50.0, 50.0, -50.0, 50.0)));
+  mobility.Install (clientServerNodes.Get(0));
+  BuildingsHelper::Install (clientServerNodes.Get(0));
+
+ // Create Devices and install them in the Nodes (eNBs and UE)
+  NetDeviceContainer lteEnbDevs = ptr_mmWave->InstallLteEnbDevice (lteEnbNodes);
+  NetDeviceContainer mmWaveEnbDevs = ptr_mmWave->InstallEnbDevice (mmWaveEnbNodes);
+  NetDeviceContainer ueDevs = InstallDualConnectedUes (ptr_mmWave, mode, clientServerNodes.Get (0));
+  //X2 between the LTE and the mmWave eNB, it carries the data of a dual connected UE
+  ptr_mmWave->AddX2Interface (lteEnbNodes, mmWaveEnbNodes);
+
+  //Create P2P link between the PGW and the server
+  PointToPointHelper pointToPoint;
+  //Set P2P attributes
+  pointToPoint.SetDeviceAttribute ("DataRate", StringValue ("10Gbps"));
+  pointToPoint.SetChannelAttribute ("Delay", StringValue ("5ms"));
+
+  //Use the internet stack helper and install on the ue and server nodes
+  InternetStackHelper internet;
+  internet.Install (clientServerNodes);
+
+  //Assigning IP addresses, the server gets one on the PGW link and the UE one from the EPC
+  uint16_t port = 50000;
+  ConnectRemoteHost (epcHelper, clientServerNodes.Get (1), pointToPoint, false);
+  std::vector<Address> ueAddresses = AssignUeAddresses (epcHelper, NodeContainer (clientServerNodes.Get (0)), ueDevs, false);
+
+  // Attach the UE to the closest eNB of each RAT once it has an address
+  AttachDualConnectedUes (ptr_mmWave, mode, ueDevs, mmWaveEnbDevs, lteEnbDevs);
+  BlockageStats blockageStats ("BlockageEventsmmwaveDualConnectivity.csv", MilliSeconds (50));
+  blockageStats.Install (blockage, clientServerNodes.Get (0), mmWaveEnbNodes, clientServerNodes, Seconds (1.0));
+  DualConnectivityStats dcStats ("RatSwitchesmmwaveDualConnectivity.csv");
+  dcStats.Install (Seconds (1.0), mode, lteEnbDevs);
+
+  // Create a UDP Server on the UE
+  UdpServerHelper server (port);
+  ApplicationContainer apps = server.Install (clientServerNodes.Get (0));
+  apps.Start (Seconds (1.0));
+
+ // Constant rate UDP download from the server to the UE
+   uint32_t MaxPacketSize = 1400; //size of each packet sent
+   Time interPacketInterval = Seconds (MaxPacketSize * 8 / (dlRate * 1e6)); //how often to send packets
+   UdpClientHelper client (ueAddresses[0], port);
+   client.SetAttribute ("MaxPackets", UintegerValue (0xFFFFFFFF));
+   client.SetAttribute ("Interval", TimeValue (interPacketInterval));
+   client.SetAttribute ("PacketSize", UintegerValue (MaxPacketSize));
+   apps = client.Install (clientServerNodes.Get (1));
+   apps.Start (Seconds (2.0));
+
+// Flow monitor
+Ptr<FlowMonitor> flowMonitor;
+FlowMonitorHelper flowHelper;
+flowMonitor = flowHelper.Install (clientServerNodes); //end hosts only, the EPC nodes would report the GTP tunnels
+//Specifying histogram bin widths for delay, jitter and packet size
+flowMonitor->SetAttribute("DelayBinWidth", DoubleValue(0.001));
+flowMonitor->SetAttribute("JitterBinWidth", DoubleValue(0.001));
+flowMonitor->SetAttribute("PacketSizeBinWidth", DoubleValue(20));
+
+//Running and Stopping simulation
+  Simulator::Stop (Seconds (simTime));
+  Simulator::Run ();
+
+//Callback to class, checks for packets that appear to be lost
+flowMonitor->CheckForLostPackets();
+
+//Print the download, the blockages of the mmWave link, the outage and the RAT switches
+PrintFlowMetrics (flowMonitor, flowHelper);
+blockageStats.Finish ();
+std::cout << " Outage: " << 100 * blockageStats.GetOutage (outageRate) << " % of 50 ms windows under "
+          << outageRate << " Mbps\n";
+dcStats.Print ();
+
+//Flow monitor file generation
+flowMonitor->SerializeToXmlFile("FlowMonitormmwaveDualConnectivity.xml", true, true); //histograms and probes enabled
+
+  Simulator::Destroy ();
+  return 0;
+}
@@ -0,0 +1,323 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//One UE browsing, on a call, syncing and streaming at the same time over
+//mmWave. Every application is reported on its own, so the delay the best
+//effort traffic adds to the call can be compared with MixedTraffic.
+
+//Import libraries
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/config-store.h"
+#include <ns3/buildings-helper.h>
+#include "ns3/internet-stack-helper.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/applications-module.h"
+#include "ns3/energy-module.h"
+#include "ns3/flow-monitor-helper.h"
+#include "ns3/ipv4-flow-classifier.h"
+#include "ns3/mmwave-helper.h"
+#include "ns3/mmwave-point-to-point-epc-helper.h"
+
+#include "flow-metrics.h"
+#include "ue-energy-model.h"
+#include "epc-topology.h"
+#include "bearer-config.h"
+#include "background-load.h"
+#include "building-grid.h"
+#include "carrier-aggregation.h"
+#include "mmwave-numerology.h"
+#include "traffic-profiles.h"
+#include "latency-budget.h"
+#include "rlc-queue-stats.h"
+#include "server-aqm.h"
+
+//Define namespace
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("mmWaveMixedTraffic");
+
+//Checking for lost packets as part of the Flow Monitor
+ void
+ FlowMonitor::CheckForLostPackets (Time maxDelay)
+ {
+   NS_LOG_FUNCTION (this << maxDelay.GetSeconds ());
+   Time now = Simulator::Now ();
+
+   for (TrackedPacketMap::iterator iter = m_trackedPackets.begin ();
+        iter != m_trackedPackets.end (); )
+     {
+       if (now - iter->second.lastSeenTime >= maxDelay)
+         {
+           // packet is considered lost, add it to the loss statistics
+           FlowStatsContainerI flow = m_flowStats.find (iter->first.first);
+           NS_ASSERT (flow != m_flowStats.end ());
+           flow->second.lostPackets++;
+
+           // we won't track it anymore
+           m_trackedPackets.erase (iter++);
+         }
+       else
+         {
+           iter++;
+         }
+     }
+ }
+
+//Main function
+int main (int argc, char *argv[])
+{
+  //Defaults if none given at runtime
+  double simTime = 10.0;
+  bool useCa = false;
+  uint16_t numCcs = 2; //component carriers with useCa
+  std::string ccManager = "rr"; //round robin split over the carriers
+  MmWaveNumerology numerology = DefaultMmWaveNumerology (); //28GHz, 1GHz in 72 chunks, 24 symbols per 100us
+  std::string profile = "http,voip,tcp,udp"; //applications on the UE
+  std::string tcpRate = "5Mbps"; //background sync upload rate
+  bool appBearers = true; //one dedicated bearer per application, otherwise all on the default bearer
+  std::string bearers = "";
+  std::string sweepFile = ""; //numerology sweep CSV the run is appended to, none if empty
+  uint32_t bgUes = 0; //background UEs loading the cell
+  double bgLoad = 0.7; //share of the cell rate they offer
+  std::string bgTraffic = "cbr";
+  std::string rlcMode = "default"; //RLC of the bearers: default, um or am
+  uint32_t rlcBuffer = 0; //RLC transmit buffer [bytes], 0 keeps the default
+  double rlcWindow = 0.1; //RLC queue sample interval [s], 0 disables
+  std::string aqm = "none"; //queue disc on the server link: none, fqcodel, pie or red
+  double queueInterval = 0.1; //server link queue sample interval [s], 0 disables
+  std::string rlcSweepFile = ""; //RLC sweep CSV the run is appended to, none if empty
+  bool latencyBudget = true; //split the UE latency into backhaul, RLC queue and MAC/PHY
+  BuildingGrid grid = DefaultBuildingGrid (); //open space unless buildingBlocks is set
+
+  //Command line arguments, overrides defaults if given
+  CommandLine cmd;
+  cmd.AddValue ("simTime", "Total duration of the simulation", simTime);
+  cmd.AddValue ("useCa", "Whether to use carrier aggregation.", useCa);
+  cmd.AddValue ("numCcs", "Number of component carriers with carrier aggregation", numCcs);
+  cmd.AddValue ("ccManager", "Carrier manager: rr (equal split) or noop (primary carrier only)", ccManager);
+  cmd.AddValue ("centreFreq", "Carrier centre frequency [Hz]", numerology.centreFreqHz);
+  cmd.AddValue ("symbolsPerSubframe", "OFDM symbols per subframe", numerology.symbolsPerSubframe);
+  cmd.AddValue ("subframePeriod", "Subframe period [us]", numerology.subframePeriodUs);
+  cmd.AddValue ("chunkPerRb", "Chunks per resource block", numerology.chunkPerRb);
+  cmd.AddValue ("rbNum", "Resource blocks of the carrier", numerology.rbNum);
+  cmd.AddValue ("chunkWidth", "Width of a chunk of 48 subcarriers [Hz]", numerology.chunkWidthHz);
+  cmd.AddValue ("profile", "Applications on the UE, comma separated from http, voip, tcp and udp", profile);
+  cmd.AddValue ("tcpRate", "Data rate of the background TCP sync", tcpRate);
+  cmd.AddValue ("appBearers", "Put every application on a dedicated bearer with the QCI of its type", appBearers);
+  cmd.AddValue ("bearers", "Extra dedicated bearers as qci:port or qci:firstPort-lastPort, comma separated", bearers);
+  cmd.AddValue ("sweepFile", "CSV file the numerology, throughput, latency and wall time are appended to", sweepFile);
+  cmd.AddValue ("bgUes", "Number of background UEs loading the cell", bgUes);
+  cmd.AddValue ("bgLoad", "Share of the cell rate offered by the background UEs", bgLoad);
+  cmd.AddValue ("bgTraffic", "Background traffic: fullbuffer, cbr or poisson", bgTraffic);
+  cmd.AddValue ("rlcMode", "RLC mode of the bearers: default, um or am", rlcMode);
+  cmd.AddValue ("rlcBuffer", "RLC transmit buffer of every bearer [bytes], 0 keeps the default", rlcBuffer);
+  cmd.AddValue ("rlcWindow", "Interval of the RLC queue occupancy and sojourn records [s], 0 disables them", rlcWindow);
+  cmd.AddValue ("aqm", "Queue disc on both ends of the server link: none (pfifo_fast), fqcodel, pie or red", aqm);
+  cmd.AddValue ("queueInterval", "Interval of the server link queue length, sojourn and drop records [s], 0 disables them", queueInterval);
+  cmd.AddValue ("rlcSweepFile", "CSV file the RLC mode, buffer, throughput, sojourn and drops are appended to", rlcSweepFile);
+  cmd.AddValue ("latencyBudget", "Print the latency of the UE per layer and bearer", latencyBudget);
+  cmd.AddValue ("buildingBlocks", "Blocks per side of the urban grid around the eNB, 0 for open space", grid.blocks);
+  cmd.AddValue ("blockSize", "Side of a building block [m]", grid.blockSize);
+  cmd.AddValue ("streetWidth", "Width of the streets between the blocks [m]", grid.streetWidth);
+  cmd.AddValue ("floors", "Floors of every building", grid.floors);
+  cmd.AddValue ("wallLoss", "Loss of the external walls of the buildings [dB]", grid.wallLossDb);
+  cmd.Parse (argc, argv);
+
+  LogComponentEnable ("mmWaveMixedTraffic", LOG_INFO);
+
+  // Parse again so you can override default values from the command line
+  cmd.Parse (argc, argv);
+
+  //PHY/MAC numerology, aborts on an inconsistent combination
+  ConfigureMmWaveNumerology (numerology);
+
+  //If user carrier aggregation is set to true via the command line...
+  if (useCa)
+    {
+      ConfigureMmWaveCa (numCcs, ccManager);
+    }
+
+//Creating the mmwavehelper object
+  Ptr<MmWaveHelper> ptr_mmWave = CreateObject<MmWaveHelper> ();
+  //The server is a remote host behind the PGW, so the traffic crosses the bearers
+  Ptr<MmWavePointToPointEpcHelper> epcHelper = CreateObject<MmWavePointToPointEpcHelper> ();
+  ptr_mmWave->SetEpcHelper (epcHelper);
+
+  //and then initialising it
+  ptr_mmWave->Initialize ();
+
+  //Urban grid around the eNB, the links of indoor nodes cross the walls
+  CreateBuildingGrid (grid);
+  Ptr<BuildingPenetrationLossModel> buildingLoss = InstallBuildingLoss (ptr_mmWave, useCa ? numCcs : 1, grid);
+
+  // Create Nodes: 1 eNodeB, 1 UE and 1 server
+  NodeContainer enbNodes;
+  NodeContainer clientServerNodes;
+  enbNodes.Create (1);
+  clientServerNodes.Create (2);
+
+  // Install Mobility Model
+  MobilityHelper mobility;
+    //set non moving enb nodes
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (enbNodes);
+  BuildingsHelper::Install (enbNodes);
+    //set non walking ue nodes
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (clientServerNodes.Get(0));
+  BuildingsHelper::Install (clientServerNodes.Get(0));
+
+  // Create Devices and install them in the Nodes (eNB and UE)
+  NetDeviceContainer enbDevs = ptr_mmWave->InstallEnbDevice (enbNodes);
+  //RLC of the bearers the EPC sets up on attach
+  uint32_t rlcBufferBytes = ConfigureRlc (rlcMode, rlcBuffer);
+  NetDeviceContainer ueDevs= ptr_mmWave->InstallUeDevice (clientServerNodes.Get (0));
+
+  //Background UEs within 100m, the cell peaks at about 1bit/s per Hz of every carrier
+  BackgroundLoad background (bgUes, bgLoad, bgTraffic, (useCa ? numCcs : 1) * MmWavePeakDlMbps (numerology));
+  NetDeviceContainer bgDevs = ptr_mmWave->InstallUeDevice (background.CreateUes (enbNodes.Get (0), 100.0));
+
+  //Create P2P link between the PGW and the server
+  PointToPointHelper pointToPoint;
+  //Set P2P attributes
+  pointToPoint.SetDeviceAttribute ("DataRate", StringValue ("10Gbps"));
+  pointToPoint.SetChannelAttribute ("Delay", StringValue ("5ms"));
+
+  //Use the internet stack helper and install on the ue and server nodes
+  InternetStackHelper internet;
+  internet.Install (clientServerNodes);
+
+  //Assigning IP addresses, the server gets one on the PGW link and the UE one from the EPC
+  Address serverAddress = ConnectRemoteHost (epcHelper, clientServerNodes.Get (1), pointToPoint, false);
+  //Queue disc on both ends of the server link
+  ServerAqm serverAqm (aqm);
+  serverAqm.Install (epcHelper, clientServerNodes.Get (1), "ServerQueuemmwaveMixedTraffic.csv", Seconds (queueInterval));
+  AssignUeAddresses (epcHelper, NodeContainer (clientServerNodes.Get (0)), ueDevs, false);
+  background.Install (epcHelper, bgDevs, pointToPoint, false, Seconds (1.0)); //own remote host, not in the flow monitor
+
+  // Attach a UE to a eNB once it has an address, the EPC sets up the default bearer
+  ptr_mmWave->AttachToClosestEnb (ueDevs, enbDevs.Get (0));
+  ptr_mmWave->AttachToClosestEnb (bgDevs, enbDevs.Get (0));
+  //Per layer latency of the UE bearers, hooked once they are set up
+  LatencyBudget budget;
+  if (latencyBudget)
+    {
+      budget.Install (clientServerNodes.Get (0), enbNodes, clientServerNodes.Get (1), Seconds (1.0));
+    }
+  RlcQueueStats rlcQueues ("RlcQueuemmwaveMixedTraffic.csv", Seconds (rlcWindow), rlcBufferBytes);
+  if (rlcWindow > 0)
+    {
+      rlcQueues.Install (Seconds (1.0));
+    }
+  CarrierStats carrierStats;
+  if (useCa)
+    {
+      carrierStats.InstallMmWave (enbNodes.GetN (), Seconds (1.0));
+    }
+
+  // Install the applications of the profile, each with its own server port
+  TrafficProfiles traffic (clientServerNodes.Get (1), serverAddress, false);
+  traffic.SetTcpRate (tcpRate);
+  traffic.Install (profile, clientServerNodes.Get (0), Seconds (2.0));
+
+  // Activate a dedicated bearer per application with the QCI of its type, plus any extra ones
+  std::vector<BearerSpec> ueBearers = ParseBearers (bearers);
+  if (appBearers)
+    {
+      std::vector<BearerSpec> appSpecs = traffic.GetBearers ();
+      ueBearers.insert (ueBearers.begin (), appSpecs.begin (), appSpecs.end ());
+    }
+  ActivateBearers (ptr_mmWave, ueDevs, ueBearers);
+
+   //UE battery, 3000 mAh and 3.7V is average mobile phone
+   LiIonEnergySourceHelper liIonSourceHelper;
+   liIonSourceHelper.Set ("LiIonEnergySourceInitialEnergyJ", DoubleValue (35000.00));
+   liIonSourceHelper.Set ("InitialCellVoltage", DoubleValue (3.7));
+   //the radio model updates the source on every RRC/DRX state change, no polling needed
+   liIonSourceHelper.Set ("PeriodicEnergyUpdateInterval", TimeValue (Seconds (simTime)));
+   EnergySourceContainer sources = liIonSourceHelper.Install (clientServerNodes.Get (0));
+   Ptr<UeRadioEnergyModel> ueEnergy = InstallUeRadioEnergyModel (clientServerNodes.Get (0), sources.Get (0));
+
+//mmWave ALL tracing
+ptr_mmWave->EnableTraces (); //creates Dl* and Ul* files
+
+//P2P tracing
+AsciiTraceHelper ascii;
+pointToPoint.EnableAsciiAll (ascii.CreateFileStream ("ASCIImmwaveMixedTraffic.tr")); //ascii
+pointToPoint.EnablePcapAll ("PCAPmmwaveMixedTraffic"); //pcap
+
+// Flow monitor
+Ptr<FlowMonitor> flowMonitor;
+FlowMonitorHelper flowHelper;
+flowMonitor = flowHelper.Install (clientServerNodes); //end hosts only, the EPC nodes would report the GTP tunnels
+//Specifying histogram bin widths for delay, jitter and packet size
+flowMonitor->SetAttribute("DelayBinWidth", DoubleValue(0.001));
+flowMonitor->SetAttribute("JitterBinWidth", DoubleValue(0.001));
+flowMonitor->SetAttribute("PacketSizeBinWidth", DoubleValue(20));
+
+//Running and Stopping simulation
+  Simulator::Stop (Seconds (simTime));
+  carrierStats.StartClock ();
+  Simulator::Run ();
+  carrierStats.StopClock ();
+
+//Callback to class, checks for packets that appear to be lost
+flowMonitor->CheckForLostPackets();
+
+//Print the metrics of every flow tagged with its application, then per application
+traffic.Print (flowMonitor, flowHelper);
+PrintUeEnergy (flowMonitor, flowHelper, ueEnergy);
+background.Print ();
+rlcQueues.Finish ();
+serverAqm.Print ();
+PrintBuildingGrid (grid, buildingLoss);
+if (latencyBudget)
+  {
+    budget.Print ();
+  }
+if (useCa)
+  {
+    carrierStats.Print ();
+  }
+
+//Append throughput of all applications and latency of the UDP stream (or the call) for this numerology
+if (!sweepFile.empty ())
+  {
+    std::map<std::string, FlowMonitor::FlowStats> perApp = traffic.MergeByType (flowMonitor, flowHelper);
+    std::map<std::string, FlowMonitor::FlowStats>::const_iterator timed = perApp.find ("udp");
+    if (timed == perApp.end ())
+      {
+        timed = perApp.find ("voip");
+      }
+    FlowMetrics latency = ComputeFlowMetrics (timed == perApp.end () ? FlowMonitor::FlowStats () : timed->second);
+    AppendNumerologySweep (sweepFile, numerology, TotalGoodputMbps (flowMonitor),
+                           latency.meanDelayMs, latency.p95DelayMs, carrierStats.GetWallMs ());
+  }
+
+//Append throughput and RLC sojourn of this RLC mode and buffer
+if (!rlcSweepFile.empty ())
+  {
+    AppendRlcSweep (rlcSweepFile, rlcMode, rlcBufferBytes, TotalGoodputMbps (flowMonitor), rlcQueues);
+  }
+
+//Flow monitor file generation
+flowMonitor->SerializeToXmlFile("FlowMonitormmwaveMixedTraffic.xml", true, true); //histograms and probes enabled
+
+  Simulator::Destroy ();
+  return 0;
+}
@@ -0,0 +1,34 @@
+#!/bin/sh
+# Sweep the mmWave PHY/MAC numerology on mmwaveMixedTraffic (a bulk TCP
+# upload and a UDP stream on one UE). Run from the 'ns3-mmwave' folder,
+# like './waf --run'. Every run appends one line (throughput, UDP latency,
+# wall clock time) to $SWEEP_FILE; inconsistent combinations are rejected
+# by the scenario and skipped.
+#
+#   sh scratch/mmwaveNumerologySweep.sh
+#   FREQS="28e9" CHUNKS="24 72" sh scratch/mmwaveNumerologySweep.sh
+
+SIM_TIME=${SIM_TIME:-4}
+TCP_RATE=${TCP_RATE:-2Gbps}
+SWEEP_FILE=${SWEEP_FILE:-NumerologySweepmmwaveMixedTraffic.csv}
+
+FREQS=${FREQS:-"28e9 73e9"}
+CHUNKS=${CHUNKS:-"24 48 72"}
+# subcarrier spacing scale: chunk width [Hz] and the subframe period [us]
+# that keeps 24 symbols with the same cyclic prefix share
+NUMEROLOGIES=${NUMEROLOGIES:-"13.889e6:100 27.778e6:50 55.556e6:25"}
+
+for freq in $FREQS; do
+  for chunks in $CHUNKS; do
+    for num in $NUMEROLOGIES; do
+      width=${num%%:*}
+      period=${num##*:}
+      args="--centreFreq=$freq --chunkPerRb=$chunks --chunkWidth=$width --subframePeriod=$period"
+      echo "mmwaveMixedTraffic $args"
+      ./waf --run "scratch/mmwaveMixedTraffic --simTime=$SIM_TIME --profile=tcp,udp --tcpRate=$TCP_RATE --appBearers=false --sweepFile=$SWEEP_FILE $args" > /dev/null \
+        || echo "  skipped"
+    done
+  done
+done
+
+echo "Results in $SWEEP_FILE"
@@ -0,0 +1,212 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//Latency under load over mmWave: one UE pings an echo server with small UDP
+//probes, first on an idle link and then while a saturating TCP download
+//(or upload) runs on the same bearer. Reports the idle and loaded RTT
+//distributions of the probes and the responsiveness in round trips per
+//minute, to compare with Responsiveness.
+
+//Import libraries
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/config-store.h"
+#include <ns3/buildings-helper.h>
+#include "ns3/internet-stack-helper.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/applications-module.h"
+#include "ns3/flow-monitor-helper.h"
+#include "ns3/ipv4-flow-classifier.h"
+#include "ns3/mmwave-helper.h"
+#include "ns3/mmwave-point-to-point-epc-helper.h"
+
+#include "flow-metrics.h"
+#include "epc-topology.h"
+#include "mmwave-numerology.h"
+#include "rlc-queue-stats.h"
+#include "server-aqm.h"
+#include "responsiveness.h"
+
+//Define namespace
+using namespace ns3;
+using namespace mmwave;
+
+NS_LOG_COMPONENT_DEFINE ("mmwaveResponsiveness");
+
+//Checking for lost packets as part of the Flow Monitor
+ void
+ FlowMonitor::CheckForLostPackets (Time maxDelay)
+ {
+   NS_LOG_FUNCTION (this << maxDelay.GetSeconds ());
+   Time now = Simulator::Now ();
+
+   for (TrackedPacketMap::iterator iter = m_trackedPackets.begin ();
+        iter != m_trackedPackets.end (); )
+     {
+       if (now - iter->second.lastSeenTime >= maxDelay)
+         {
+           // packet is considered lost, add it to the loss statistics
+           FlowStatsContainerI flow = m_flowStats.find (iter->first.first);
+           NS_ASSERT (flow != m_flowStats.end ());
+           flow->second.lostPackets++;
+
+           // we won't track it anymore
+           m_trackedPackets.erase (iter++);
+         }
+       else
+         {
+           iter++;
+         }
+     }
+ }
+
+//Main function
+int main (int argc, char *argv[])
+{
+  //Defaults if none given at runtime
+  double simTime = 20.0;
+  double idleTime = 5.0; //probes alone before the load starts [s]
+  double distance = 50.0; //of the UE from the eNB [m]
+  std::string load = "download"; //saturating TCP flow: download or upload
+  double probeInterval = 0.1; //[s]
+  uint32_t probeSize = 64; //bytes of UDP payload
+  std::string rlcMode = "default"; //RLC of the bearers: default, um or am
+  uint32_t rlcBuffer = 0; //RLC transmit buffer [bytes], 0 keeps the default
+  std::string aqm = "none"; //queue disc on the server link: none, fqcodel, pie or red
+  MmWaveNumerology numerology = DefaultMmWaveNumerology (); //28GHz, 1GHz in 72 chunks, 24 symbols per 100us
+
+  //Command line arguments, overrides defaults if given
+  CommandLine cmd;
+  cmd.AddValue ("simTime", "Total duration of the simulation", simTime);
+  cmd.AddValue ("idleTime", "Time the probes run on an idle link before the load starts [s]", idleTime);
+  cmd.AddValue ("distance", "Distance of the UE from the eNB [m]", distance);
+  cmd.AddValue ("load", "Saturating TCP flow on the UE: download or upload", load);
+  cmd.AddValue ("probeInterval", "Interval between probes [s]", probeInterval);
+  cmd.AddValue ("probeSize", "UDP payload of a probe [bytes]", probeSize);
+  cmd.AddValue ("rlcMode", "RLC mode of the bearers: default, um or am", rlcMode);
+  cmd.AddValue ("rlcBuffer", "RLC transmit buffer of every bearer [bytes], 0 keeps the default", rlcBuffer);
+  cmd.AddValue ("aqm", "Queue disc on both ends of the server link: none (pfifo_fast), fqcodel, pie or red", aqm);
+  cmd.AddValue ("centreFreq", "Carrier centre frequency [Hz]", numerology.centreFreqHz);
+  cmd.AddValue ("symbolsPerSubframe", "OFDM symbols per subframe", numerology.symbolsPerSubframe);
+  cmd.AddValue ("subframePeriod", "Subframe period [us]", numerology.subframePeriodUs);
+  cmd.AddValue ("chunkPerRb", "Chunks per resource block", numerology.chunkPerRb);
+  cmd.AddValue ("rbNum", "Resource blocks of the carrier", numerology.rbNum);
+  cmd.AddValue ("chunkWidth", "Width of a chunk of 48 subcarriers [Hz]", numerology.chunkWidthHz);
+  cmd.Parse (argc, argv);
+
+  LogComponentEnable ("mmwaveResponsiveness", LOG_INFO);
+
+  NS_ABORT_MSG_IF (load != "download" && load != "upload", "Unknown load " << load << ", use download or upload");
+  NS_ABORT_MSG_IF (idleTime <= 0 || simTime <= 2.0 + idleTime, "The simulation must outlast the idle phase");
+
+  //PHY/MAC numerology, aborts on an inconsistent combination
+  ConfigureMmWaveNumerology (numerology);
+
+  //Creating the mmwavehelper object
+  Ptr<MmWaveHelper> ptr_mmWave = CreateObject<MmWaveHelper> ();
+  //The server is a remote host behind the PGW, so the traffic crosses the bearers
+  Ptr<MmWavePointToPointEpcHelper> epcHelper = CreateObject<MmWavePointToPointEpcHelper> ();
+  ptr_mmWave->SetEpcHelper (epcHelper);
+
+  //and then initialising it
+  ptr_mmWave->Initialize ();
+
+  // Create Nodes: 1 eNodeB, 1 UE and 1 server
+  NodeContainer enbNodes;
+  NodeContainer clientServerNodes;
+  enbNodes.Create (1);
+  clientServerNodes.Create (2);
+
+  // Install Mobility Model
+  MobilityHelper mobility;
+    //set non moving enb and ue nodes
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (enbNodes);
+  mobility.Install (clientServerNodes.Get (0));
+  clientServerNodes.Get (0)->GetObject<MobilityModel> ()->SetPosition (Vector (distance, 0.0, 0.0));
+  BuildingsHelper::Install (enbNodes);
+  BuildingsHelper::Install (clientServerNodes.Get (0));
+
+  // Create Devices and install them in the Nodes (eNB and UE)
+  NetDeviceContainer enbDevs = ptr_mmWave->InstallEnbDevice (enbNodes);
+  //RLC of the bearers the EPC sets up on attach
+  ConfigureRlc (rlcMode, rlcBuffer);
+  NetDeviceContainer ueDevs = ptr_mmWave->InstallUeDevice (clientServerNodes.Get (0));
+
+  //Create P2P link between the PGW and the server
+  PointToPointHelper pointToPoint;
+  //Set P2P attributes
+  pointToPoint.SetDeviceAttribute ("DataRate", StringValue ("10Gbps"));
+  pointToPoint.SetChannelAttribute ("Delay", StringValue ("5ms"));
+
+  //Use the internet stack helper and install on the ue and server nodes
+  InternetStackHelper internet;
+  internet.Install (clientServerNodes);
+
+  //Assigning IP addresses, the server gets one on the PGW link and the UE one from the EPC
+  Address serverAddress = ConnectRemoteHost (epcHelper, clientServerNodes.Get (1), pointToPoint, false);
+  //Queue disc on both ends of the server link
+  ServerAqm serverAqm (aqm);
+  serverAqm.Install (epcHelper, clientServerNodes.Get (1), "ServerQueuemmwaveResponsiveness.csv", Seconds (0));
+  std::vector<Address> ueAddresses = AssignUeAddresses (epcHelper, NodeContainer (clientServerNodes.Get (0)), ueDevs, false);
+
+  // Attach a UE to a eNB once it has an address, the EPC sets up the default bearer
+  ptr_mmWave->AttachToClosestEnb (ueDevs, enbDevs.Get (0));
+
+  // Probes from 2s, both flows share the default bearer
+  Time loadStart = Seconds (2.0 + idleTime);
+  ResponsivenessProbe probe ("ProbesmmwaveResponsiveness.csv", Seconds (probeInterval), probeSize, loadStart);
+  probe.Install (clientServerNodes.Get (0), clientServerNodes.Get (1), serverAddress, 50001, Seconds (2.0), Seconds (simTime));
+
+  // Saturating TCP flow, a bulk sender with no byte limit
+  bool download = load == "download";
+  uint16_t port = 50000;
+  Ptr<Node> sender = clientServerNodes.Get (download ? 1 : 0);
+  Ptr<Node> receiver = clientServerNodes.Get (download ? 0 : 1);
+  PacketSinkHelper sinkHelper ("ns3::TcpSocketFactory", AnySocketAddress (false, port));
+  sinkHelper.Install (receiver).Start (Seconds (1.0));
+  BulkSendHelper bulk ("ns3::TcpSocketFactory", SocketAddress (download ? ueAddresses[0] : serverAddress, port));
+  bulk.SetAttribute ("MaxBytes", UintegerValue (0));
+  bulk.Install (sender).Start (loadStart);
+
+// Flow monitor
+Ptr<FlowMonitor> flowMonitor;
+FlowMonitorHelper flowHelper;
+flowMonitor = flowHelper.Install (clientServerNodes); //end hosts only, the EPC nodes would report the GTP tunnels
+//Specifying histogram bin widths for delay, jitter and packet size
+flowMonitor->SetAttribute("DelayBinWidth", DoubleValue(0.001));
+flowMonitor->SetAttribute("JitterBinWidth", DoubleValue(0.001));
+flowMonitor->SetAttribute("PacketSizeBinWidth", DoubleValue(20));
+
+//Running and Stopping simulation
+  Simulator::Stop (Seconds (simTime));
+  Simulator::Run ();
+
+//Callback to class, checks for packets that appear to be lost
+flowMonitor->CheckForLostPackets();
+
+//Print the TCP load and the probes of each flow, then the probe RTTs idle and loaded
+PrintFlowMetrics (flowMonitor, flowHelper);
+serverAqm.Print ();
+probe.Print ();
+
+//Flow monitor file generation
+flowMonitor->SerializeToXmlFile("FlowMonitormmwaveResponsiveness.xml", true, true); //histograms and probes enabled
+
+  Simulator::Destroy ();
+  return 0;
+}
@@ -0,0 +1,183 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//Edge against remote server over mmWave: one UE probes an edge server next
+//to the PGW and a remote server across a WAN in the same run, so the RTT
+//the radio costs can be told apart from the RTT the server placement
+//costs. To compare with ServerPlacement.
+
+//Import libraries
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/config-store.h"
+#include <ns3/buildings-helper.h>
+#include "ns3/internet-stack-helper.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/applications-module.h"
+#include "ns3/flow-monitor-helper.h"
+#include "ns3/ipv4-flow-classifier.h"
+#include "ns3/mmwave-helper.h"
+#include "ns3/mmwave-point-to-point-epc-helper.h"
+
+#include "flow-metrics.h"
+#include "epc-topology.h"
+#include "mmwave-numerology.h"
+#include "responsiveness.h"
+#include "server-placement.h"
+
+//Define namespace
+using namespace ns3;
+using namespace mmwave;
+
+NS_LOG_COMPONENT_DEFINE ("mmwaveServerPlacement");
+
+//Checking for lost packets as part of the Flow Monitor
+ void
+ FlowMonitor::CheckForLostPackets (Time maxDelay)
+ {
+   NS_LOG_FUNCTION (this << maxDelay.GetSeconds ());
+   Time now = Simulator::Now ();
+
+   for (TrackedPacketMap::iterator iter = m_trackedPackets.begin ();
+        iter != m_trackedPackets.end (); )
+     {
+       if (now - iter->second.lastSeenTime >= maxDelay)
+         {
+           // packet is considered lost, add it to the loss statistics
+           FlowStatsContainerI flow = m_flowStats.find (iter->first.first);
+           NS_ASSERT (flow != m_flowStats.end ());
+           flow->second.lostPackets++;
+
+           // we won't track it anymore
+           m_trackedPackets.erase (iter++);
+         }
+       else
+         {
+           iter++;
+         }
+     }
+ }
+
+//Main function
+int main (int argc, char *argv[])
+{
+  //Defaults if none given at runtime
+  double simTime = 10.0;
+  double distance = 50.0; //of the UE from the eNB [m]
+  ServerPlacement placement = DefaultServerPlacement (); //edge 0.5ms, remote 20ms away
+  double probeInterval = 0.1; //[s]
+  uint32_t probeSize = 64; //bytes of UDP payload
+  MmWaveNumerology numerology = DefaultMmWaveNumerology (); //28GHz, 1GHz in 72 chunks, 24 symbols per 100us
+
+  //Command line arguments, overrides defaults if given
+  CommandLine cmd;
+  cmd.AddValue ("simTime", "Total duration of the simulation", simTime);
+  cmd.AddValue ("distance", "Distance of the UE from the eNB [m]", distance);
+  cmd.AddValue ("edgeDelay", "Delay of the link from the PGW to the edge server [ms]", placement.edgeDelayMs);
+  cmd.AddValue ("edgeRate", "Data rate of the link from the PGW to the edge server", placement.edgeRate);
+  cmd.AddValue ("wanDelay", "Delay of the WAN from the PGW to the remote server [ms]", placement.wanDelayMs);
+  cmd.AddValue ("wanRate", "Data rate of the WAN from the PGW to the remote server", placement.wanRate);
+  cmd.AddValue ("probeInterval", "Interval between probes to each server [s]", probeInterval);
+  cmd.AddValue ("probeSize", "UDP payload of a probe [bytes]", probeSize);
+  cmd.AddValue ("centreFreq", "Carrier centre frequency [Hz]", numerology.centreFreqHz);
+  cmd.AddValue ("symbolsPerSubframe", "OFDM symbols per subframe", numerology.symbolsPerSubframe);
+  cmd.AddValue ("subframePeriod", "Subframe period [us]", numerology.subframePeriodUs);
+  cmd.AddValue ("chunkPerRb", "Chunks per resource block", numerology.chunkPerRb);
+  cmd.AddValue ("rbNum", "Resource blocks of the carrier", numerology.rbNum);
+  cmd.AddValue ("chunkWidth", "Width of a chunk of 48 subcarriers [Hz]", numerology.chunkWidthHz);
+  cmd.Parse (argc, argv);
+
+  LogComponentEnable ("mmwaveServerPlacement", LOG_INFO);
+
+  //PHY/MAC numerology, aborts on an inconsistent combination
+  ConfigureMmWaveNumerology (numerology);
+
+  //Creating the mmwavehelper object
+  Ptr<MmWaveHelper> ptr_mmWave = CreateObject<MmWaveHelper> ();
+  //The servers are remote hosts behind the PGW, so the traffic crosses the bearers
+  Ptr<MmWavePointToPointEpcHelper> epcHelper = CreateObject<MmWavePointToPointEpcHelper> ();
+  ptr_mmWave->SetEpcHelper (epcHelper);
+
+  //and then initialising it
+  ptr_mmWave->Initialize ();
+
+  // Create Nodes: 1 eNodeB, 1 UE, the edge and the remote server
+  NodeContainer enbNodes;
+  NodeContainer clientServerNodes;
+  enbNodes.Create (1);
+  clientServerNodes.Create (3);
+
+  // Install Mobility Model
+  MobilityHelper mobility;
+    //set non moving enb and ue nodes
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (enbNodes);
+  mobility.Install (clientServerNodes.Get (0));
+  clientServerNodes.Get (0)->GetObject<MobilityModel> ()->SetPosition (Vector (distance, 0.0, 0.0));
+  BuildingsHelper::Install (enbNodes);
+  BuildingsHelper::Install (clientServerNodes.Get (0));
+
+  // Create Devices and install them in the Nodes (eNB and UE)
+  NetDeviceContainer enbDevs = ptr_mmWave->InstallEnbDevice (enbNodes);
+  NetDeviceContainer ueDevs = ptr_mmWave->InstallUeDevice (clientServerNodes.Get (0));
+
+  //Use the internet stack helper and install on the ue and server nodes
+  InternetStackHelper internet;
+  internet.Install (clientServerNodes);
+
+  //Assigning IP addresses, each server gets one on its own PGW link and the UE one from the EPC
+  Address edgeAddress;
+  Address remoteAddress;
+  ConnectServers (epcHelper, clientServerNodes.Get (1), clientServerNodes.Get (2), placement, edgeAddress, remoteAddress);
+  AssignUeAddresses (epcHelper, NodeContainer (clientServerNodes.Get (0)), ueDevs, false);
+
+  // Attach a UE to a eNB once it has an address, the EPC sets up the default bearer
+  ptr_mmWave->AttachToClosestEnb (ueDevs, enbDevs.Get (0));
+
+  // Probes to both servers from 2s, interleaved so they never queue behind each other
+  ResponsivenessProbe edgeProbe ("ProbesEdgemmwaveServerPlacement.csv", Seconds (probeInterval), probeSize, Time::Max ());
+  edgeProbe.Install (clientServerNodes.Get (0), clientServerNodes.Get (1), edgeAddress, 50001, Seconds (2.0), Seconds (simTime));
+  ResponsivenessProbe remoteProbe ("ProbesRemotemmwaveServerPlacement.csv", Seconds (probeInterval), probeSize, Time::Max ());
+  remoteProbe.Install (clientServerNodes.Get (0), clientServerNodes.Get (2), remoteAddress, 50002,
+                       Seconds (2.0 + probeInterval / 2), Seconds (simTime));
+
+// Flow monitor
+Ptr<FlowMonitor> flowMonitor;
+FlowMonitorHelper flowHelper;
+flowMonitor = flowHelper.Install (clientServerNodes); //end hosts only, the EPC nodes would report the GTP tunnels
+//Specifying histogram bin widths for delay, jitter and packet size
+flowMonitor->SetAttribute("DelayBinWidth", DoubleValue(0.001));
+flowMonitor->SetAttribute("JitterBinWidth", DoubleValue(0.001));
+flowMonitor->SetAttribute("PacketSizeBinWidth", DoubleValue(20));
+
+//Running and Stopping simulation
+  Simulator::Stop (Seconds (simTime));
+  Simulator::Run ();
+
+//Callback to class, checks for packets that appear to be lost
+flowMonitor->CheckForLostPackets();
+
+//Print the one way delay of each probe flow, then the RTT to each server and its split
+PrintFlowMetrics (flowMonitor, flowHelper);
+PrintServerPlacement (placement, edgeProbe, remoteProbe);
+
+//Flow monitor file generation
+flowMonitor->SerializeToXmlFile("FlowMonitormmwaveServerPlacement.xml", true, true); //histograms and probes enabled
+
+  Simulator::Destroy ();
+  return 0;
+}
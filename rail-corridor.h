@@ -0,0 +1,298 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//Linear rail corridor deployment: cell sites are placed along a polyline
+//track at a fixed inter-site distance and the UEs ride the track with a
+//piecewise constant speed profile.
+//
+//The train uses WaypointMobilityModel with one waypoint per track vertex
+//and speed change, so the cost does not grow with the number of sites.
+//X2 links are only added between nearby sites instead of the full mesh
+//LteHelper::AddX2Interface (NodeContainer) would build.
+
+#ifndef RAIL_CORRIDOR_H
+#define RAIL_CORRIDOR_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/lte-module.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <vector>
+
+namespace ns3 {
+
+class RailCorridor
+{
+public:
+  //One constant speed segment starting at the given distance along the track
+  struct SpeedStep
+  {
+    double distance; //in meters from the start of the track
+    double speed;    //in m/s
+  };
+
+  RailCorridor (const std::vector<Vector> &track)
+    : m_track (track)
+  {
+    NS_ABORT_MSG_IF (m_track.size () < 2, "A rail track needs at least two points");
+    m_cumulative.push_back (0.0);
+    for (uint32_t i = 1; i < m_track.size (); ++i)
+      {
+        m_cumulative.push_back (m_cumulative.back () + CalculateDistance (m_track[i - 1], m_track[i]));
+      }
+  }
+
+  //"x1,y1;x2,y2;..." as given on the command line
+  static std::vector<Vector>
+  ParseTrack (std::string text)
+  {
+    std::vector<Vector> points;
+    std::replace (text.begin (), text.end (), ';', ' ');
+    std::istringstream in (text);
+    std::string point;
+    while (in >> point)
+      {
+        double x = 0, y = 0;
+        char comma;
+        std::istringstream p (point);
+        p >> x >> comma >> y;
+        NS_ABORT_MSG_IF (p.fail () || comma != ',', "Bad track point " << point << ", expected x,y");
+        points.push_back (Vector (x, y, 0.0));
+      }
+    return points;
+  }
+
+  //"d1:v1,d2:v2,..." where speed v applies from distance d onwards
+  static std::vector<SpeedStep>
+  ParseSpeedProfile (std::string text)
+  {
+    std::vector<SpeedStep> steps;
+    std::replace (text.begin (), text.end (), ',', ' ');
+    std::istringstream in (text);
+    std::string item;
+    while (in >> item)
+      {
+        SpeedStep s;
+        char colon;
+        std::istringstream p (item);
+        p >> s.distance >> colon >> s.speed;
+        NS_ABORT_MSG_IF (p.fail () || colon != ':' || s.speed <= 0,
+                         "Bad speed profile step " << item << ", expected distance:speed with speed > 0");
+        steps.push_back (s);
+      }
+    return steps;
+  }
+
+  double
+  GetLength () const
+  {
+    return m_cumulative.back ();
+  }
+
+  //Point at distance s along the track, clamped to the ends
+  Vector
+  GetPosition (double s) const
+  {
+    uint32_t seg = GetSegment (s);
+    double len = m_cumulative[seg + 1] - m_cumulative[seg];
+    double f = len > 0 ? (std::min (std::max (s, 0.0), GetLength ()) - m_cumulative[seg]) / len : 0.0;
+    const Vector &a = m_track[seg];
+    const Vector &b = m_track[seg + 1];
+    return Vector (a.x + f * (b.x - a.x), a.y + f * (b.y - a.y), 0.0);
+  }
+
+  //Direction of travel at distance s, in degrees from the x axis
+  double
+  GetHeading (double s) const
+  {
+    uint32_t seg = GetSegment (s);
+    return std::atan2 (m_track[seg + 1].y - m_track[seg].y,
+                       m_track[seg + 1].x - m_track[seg].x) * 180.0 / M_PI;
+  }
+
+  //Number of sites that fit on the track from firstSite onwards
+  uint32_t
+  GetNumSites (double isd, double firstSite) const
+  {
+    if (firstSite > GetLength ())
+      {
+        return 0;
+      }
+    return static_cast<uint32_t> (std::floor ((GetLength () - firstSite) / isd)) + 1;
+  }
+
+  //Place sectorsPerSite co-located eNB nodes per site, every isd meters from
+  //firstSite and offset sideways from the track, and install one sector
+  //device per node. 1 sector is omnidirectional, 2 sectors point along the
+  //track in both directions, 3 sectors are 120 degrees apart.
+  NetDeviceContainer
+  InstallSites (Ptr<LteHelper> lteHelper, NodeContainer enbNodes, uint32_t sectorsPerSite,
+                double isd, double firstSite, double lateralOffset, double height)
+  {
+    NS_ABORT_MSG_IF (sectorsPerSite < 1 || sectorsPerSite > 3, "sectorsPerSite must be 1, 2 or 3");
+    uint32_t sites = (enbNodes.GetN () + sectorsPerSite - 1) / sectorsPerSite;
+    NS_ABORT_MSG_IF (sites > GetNumSites (isd, firstSite),
+                     sites << " sites " << isd << " m apart from " << firstSite << " m do not fit on a "
+                           << GetLength () << " m track, only " << GetNumSites (isd, firstSite) << " do");
+    Ptr<ListPositionAllocator> positions = CreateObject<ListPositionAllocator> ();
+    for (uint32_t n = 0; n < enbNodes.GetN (); ++n)
+      {
+        double s = firstSite + (n / sectorsPerSite) * isd;
+        double heading = GetHeading (s) * M_PI / 180.0;
+        Vector p = GetPosition (s);
+        //left of the direction of travel
+        positions->Add (Vector (p.x - lateralOffset * std::sin (heading),
+                                p.y + lateralOffset * std::cos (heading), height));
+      }
+    MobilityHelper mobility;
+    mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+    mobility.SetPositionAllocator (positions);
+    mobility.Install (enbNodes);
+
+    NetDeviceContainer enbDevs;
+    if (sectorsPerSite > 1)
+      {
+        lteHelper->SetEnbAntennaModelType ("ns3::ParabolicAntennaModel");
+        lteHelper->SetEnbAntennaModelAttribute ("Beamwidth", DoubleValue (sectorsPerSite == 2 ? 90 : 70));
+      }
+    for (uint32_t n = 0; n < enbNodes.GetN (); ++n)
+      {
+        if (sectorsPerSite > 1)
+          {
+            double s = firstSite + (n / sectorsPerSite) * isd;
+            double orientation = GetHeading (s) + (n % sectorsPerSite) * 360.0 / sectorsPerSite;
+            lteHelper->SetEnbAntennaModelAttribute ("Orientation", DoubleValue (orientation));
+          }
+        enbDevs.Add (lteHelper->InstallEnbDevice (enbNodes.Get (n)));
+      }
+    return enbDevs;
+  }
+
+  //X2 between every pair of sectors at most neighbourSites sites apart,
+  //the sectors of one site included
+  void
+  AddX2Interfaces (Ptr<LteHelper> lteHelper, NodeContainer enbNodes, uint32_t sectorsPerSite,
+                   uint32_t neighbourSites)
+  {
+    for (uint32_t i = 0; i < enbNodes.GetN (); ++i)
+      {
+        for (uint32_t j = i + 1; j < enbNodes.GetN (); ++j)
+          {
+            if (j / sectorsPerSite - i / sectorsPerSite > neighbourSites)
+              {
+                break;
+              }
+            lteHelper->AddX2Interface (enbNodes.Get (i), enbNodes.Get (j));
+          }
+      }
+  }
+
+  //Move the UEs along the track from startDistance. UE u rides ueSpacing * u
+  //meters behind the first, as passengers spread along the train.
+  void
+  InstallTrain (NodeContainer ueNodes, const std::vector<SpeedStep> &profile,
+                double startDistance, double ueSpacing, Time startTime)
+  {
+    NS_ABORT_MSG_IF (profile.empty (), "The speed profile is empty");
+    MobilityHelper mobility;
+    mobility.SetMobilityModel ("ns3::WaypointMobilityModel");
+    mobility.Install (ueNodes);
+
+    for (uint32_t u = 0; u < ueNodes.GetN (); ++u)
+      {
+        Ptr<WaypointMobilityModel> model = ueNodes.Get (u)->GetObject<WaypointMobilityModel> ();
+        double s = std::max (startDistance - u * ueSpacing, 0.0);
+        Time t = startTime;
+        model->AddWaypoint (Waypoint (t, GetPosition (s)));
+        while (s < GetLength ())
+          {
+            //advance to the next track vertex or speed change, whichever is first
+            double next = GetLength ();
+            std::vector<double>::const_iterator v = std::upper_bound (m_cumulative.begin (), m_cumulative.end (), s);
+            if (v != m_cumulative.end ())
+              {
+                next = std::min (next, *v);
+              }
+            double speed = GetSpeed (profile, s, next);
+            t += Seconds ((next - s) / speed);
+            s = next;
+            model->AddWaypoint (Waypoint (t, GetPosition (s)));
+          }
+      }
+  }
+
+  //Mean speed [m/s] of a train leaving startDistance with this profile,
+  //over the given time or until it reaches the end of the track
+  double
+  GetMeanSpeed (const std::vector<SpeedStep> &profile, double startDistance, Time duration) const
+  {
+    NS_ABORT_MSG_IF (profile.empty (), "The speed profile is empty");
+    double s = std::max (startDistance, 0.0);
+    double left = duration.GetSeconds ();
+    double ridden = 0;
+    while (s < GetLength () && left > 0)
+      {
+        double next = GetLength ();
+        double speed = GetSpeed (profile, s, next);
+        double dt = std::min ((next - s) / speed, left);
+        s = dt < left ? next : s + dt * speed;
+        left -= dt;
+        ridden += dt;
+      }
+    return ridden > 0 ? (s - std::max (startDistance, 0.0)) / ridden : profile.front ().speed;
+  }
+
+private:
+  //Speed of the profile at distance s, next is lowered to where it changes
+  static double
+  GetSpeed (const std::vector<SpeedStep> &profile, double s, double &next)
+  {
+    double speed = profile.front ().speed;
+    for (uint32_t k = 0; k < profile.size (); ++k)
+      {
+        if (profile[k].distance <= s)
+          {
+            speed = profile[k].speed;
+          }
+        else
+          {
+            next = std::min (next, profile[k].distance);
+            break;
+          }
+      }
+    return speed;
+  }
+
+  //Index of the track segment containing distance s
+  uint32_t
+  GetSegment (double s) const
+  {
+    std::vector<double>::const_iterator it = std::upper_bound (m_cumulative.begin (), m_cumulative.end (), s);
+    uint32_t seg = it == m_cumulative.begin () ? 0 : (it - m_cumulative.begin ()) - 1;
+    return std::min (seg, static_cast<uint32_t> (m_track.size () - 2));
+  }
+
+  std::vector<Vector> m_track;
+  std::vector<double> m_cumulative; //distance along the track at each vertex
+};
+
+} // namespace ns3
+
+#endif /* RAIL_CORRIDOR_H */
@@ -0,0 +1,309 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//Radio environment map (REM) of the downlink SINR, computed in tiles by
+//worker processes.
+//
+//Every point of the area is a probe position. The SINR is the strongest
+//eNB over the noise plus every other eNB, all transmitting at full power,
+//through the loss models and antennas the scenario uses. The area is split
+//in square tiles and each worker is a fork of the program that computes
+//every workers-th tile and writes it straight into the raster file, so
+//nothing has to be merged. The raster is
+//  "REM1", uint32 width, height, 0, double xMin, yMin, resolution
+//followed by the SINR in dB as float32, one row of width points per y from
+//yMin up. It can be exported to CSV (x,y,sinr_dB) and to an 8 bit PGM image.
+
+#ifndef REM_TILES_H
+#define REM_TILES_H
+
+#include "ns3/core-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/antenna-model.h"
+
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace ns3 {
+
+//Initial value of a double attribute, with any Config::SetDefault applied
+inline double
+DoubleDefault (std::string type, std::string attribute)
+{
+  TypeId::AttributeInformation info;
+  NS_ABORT_MSG_UNLESS (TypeId::LookupByName (type).LookupAttributeByName (attribute, &info),
+                       type << " has no attribute " << attribute);
+  return DynamicCast<const DoubleValue> (info.initialValue)->Get ();
+}
+
+//Thermal noise over the bandwidth plus the receiver noise figure
+inline double
+NoiseDbm (double bandwidthHz, double noiseFigureDb)
+{
+  return -174.0 + 10 * std::log10 (bandwidthHz) + noiseFigureDb;
+}
+
+class RemTiles
+{
+public:
+  struct Header
+  {
+    char magic[4];
+    uint32_t width;
+    uint32_t height;
+    uint32_t reserved; //keeps the doubles aligned
+    double xMin;
+    double yMin;
+    double resolution;
+  };
+
+  RemTiles (double xMin, double xMax, double yMin, double yMax, double resolution, double z)
+    : m_z (z),
+      m_noiseDbm (-100),
+      m_gainDb (0)
+  {
+    NS_ABORT_MSG_IF (resolution <= 0 || xMax < xMin || yMax < yMin, "Bad REM area or resolution");
+    std::memcpy (m_header.magic, "REM1", 4);
+    m_header.width = static_cast<uint32_t> (std::floor ((xMax - xMin) / resolution)) + 1;
+    m_header.height = static_cast<uint32_t> (std::floor ((yMax - yMin) / resolution)) + 1;
+    m_header.reserved = 0;
+    m_header.xMin = xMin;
+    m_header.yMin = yMin;
+    m_header.resolution = resolution;
+  }
+
+  //An eNB, with no antenna for an isotropic one
+  void
+  AddTransmitter (Ptr<MobilityModel> mobility, Ptr<AntennaModel> antenna, double txPowerDbm)
+  {
+    Transmitter t = { mobility, antenna, txPowerDbm };
+    m_transmitters.push_back (t);
+  }
+
+  //The probe is moved over the area, its node has whatever device the
+  //loss models need to see on a receiver
+  void
+  SetLoss (Ptr<PropagationLossModel> loss, Ptr<MobilityModel> probe)
+  {
+    m_loss = loss;
+    m_probe = probe;
+  }
+
+  void
+  SetNoiseDbm (double noiseDbm)
+  {
+    m_noiseDbm = noiseDbm;
+  }
+
+  //Gain of the link on top of the antennas, e.g. beamforming
+  void
+  SetGainDb (double gainDb)
+  {
+    m_gainDb = gainDb;
+  }
+
+  uint64_t
+  GetNumPoints () const
+  {
+    return static_cast<uint64_t> (m_header.width) * m_header.height;
+  }
+
+  //Compute the raster into filename, tileSize x tileSize points per tile
+  //shared out over the workers. Call before Simulator::Run.
+  void
+  Run (std::string filename, uint32_t tileSize, uint32_t workers)
+  {
+    NS_ABORT_MSG_IF (m_loss == 0 || m_transmitters.empty (), "The REM needs a loss model and an eNB");
+    NS_ABORT_MSG_IF (tileSize == 0 || workers == 0, "The REM needs tiles and workers");
+    int fd = open (filename.c_str (), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    NS_ABORT_MSG_IF (fd < 0, "Cannot create " << filename);
+    NS_ABORT_MSG_IF (write (fd, &m_header, sizeof (m_header)) != sizeof (m_header)
+                     || ftruncate (fd, sizeof (m_header) + GetNumPoints () * sizeof (float)) != 0,
+                     "Cannot size " << filename);
+
+    uint32_t tilesX = (m_header.width + tileSize - 1) / tileSize;
+    uint32_t tilesY = (m_header.height + tileSize - 1) / tileSize;
+    workers = std::min (workers, tilesX * tilesY);
+    if (workers == 1)
+      {
+        ComputeTiles (fd, tileSize, tilesX, tilesY, 0, 1);
+        close (fd);
+        return;
+      }
+    //the workers share nothing but the file, each with its own copy of the
+    //scenario and of the loss model caches
+    std::vector<pid_t> pids;
+    for (uint32_t w = 0; w < workers; ++w)
+      {
+        pid_t pid = fork ();
+        NS_ABORT_MSG_IF (pid < 0, "Cannot fork REM worker " << w);
+        if (pid == 0)
+          {
+            ComputeTiles (fd, tileSize, tilesX, tilesY, w, workers);
+            _exit (0);
+          }
+        pids.push_back (pid);
+      }
+    bool failed = false;
+    for (uint32_t w = 0; w < pids.size (); ++w)
+      {
+        int status = 0;
+        waitpid (pids[w], &status, 0);
+        failed = failed || !WIFEXITED (status) || WEXITSTATUS (status) != 0;
+      }
+    close (fd);
+    NS_ABORT_MSG_IF (failed, "A REM worker failed, " << filename << " is incomplete");
+  }
+
+  //x,y,sinr_dB for every point of a raster
+  static void
+  ExportCsv (std::string rasterFile, std::string csvFile)
+  {
+    Header h;
+    std::vector<float> sinr = Read (rasterFile, h);
+    std::ofstream out (csvFile.c_str ());
+    out << "x,y,sinr_dB\n";
+    for (uint32_t j = 0; j < h.height; ++j)
+      {
+        for (uint32_t i = 0; i < h.width; ++i)
+          {
+            out << h.xMin + i * h.resolution << "," << h.yMin + j * h.resolution << ","
+                << sinr[static_cast<uint64_t> (j) * h.width + i] << "\n";
+          }
+      }
+  }
+
+  //Grey levels from black at minDb to white at maxDb, north up
+  static void
+  ExportPgm (std::string rasterFile, std::string pgmFile, double minDb, double maxDb)
+  {
+    Header h;
+    std::vector<float> sinr = Read (rasterFile, h);
+    std::ofstream out (pgmFile.c_str (), std::ios::binary);
+    out << "P5\n" << h.width << " " << h.height << "\n255\n";
+    std::vector<unsigned char> row (h.width);
+    for (uint32_t j = h.height; j-- > 0; )
+      {
+        for (uint32_t i = 0; i < h.width; ++i)
+          {
+            double level = (sinr[static_cast<uint64_t> (j) * h.width + i] - minDb) / (maxDb - minDb);
+            row[i] = static_cast<unsigned char> (255 * std::min (1.0, std::max (0.0, level)) + 0.5);
+          }
+        out.write (reinterpret_cast<const char *> (&row[0]), h.width);
+      }
+  }
+
+  //Share of the points at or above the SINR
+  static double
+  Coverage (std::string rasterFile, double thresholdDb)
+  {
+    Header h;
+    std::vector<float> sinr = Read (rasterFile, h);
+    uint64_t covered = 0;
+    for (uint64_t n = 0; n < sinr.size (); ++n)
+      {
+        covered += sinr[n] >= thresholdDb;
+      }
+    return sinr.empty () ? 0.0 : static_cast<double> (covered) / sinr.size ();
+  }
+
+private:
+  struct Transmitter
+  {
+    Ptr<MobilityModel> mobility;
+    Ptr<AntennaModel> antenna;
+    double txPowerDbm;
+  };
+
+  void
+  ComputeTiles (int fd, uint32_t tileSize, uint32_t tilesX, uint32_t tilesY, uint32_t first, uint32_t step)
+  {
+    std::vector<float> row (tileSize);
+    for (uint32_t t = first; t < tilesX * tilesY; t += step)
+      {
+        uint32_t i0 = (t % tilesX) * tileSize;
+        uint32_t j0 = (t / tilesX) * tileSize;
+        uint32_t width = std::min (tileSize, m_header.width - i0);
+        for (uint32_t j = j0; j < std::min (j0 + tileSize, m_header.height); ++j)
+          {
+            for (uint32_t i = 0; i < width; ++i)
+              {
+                row[i] = Sinr (Vector (m_header.xMin + (i0 + i) * m_header.resolution,
+                                       m_header.yMin + j * m_header.resolution, m_z));
+              }
+            off_t offset = sizeof (m_header) + (static_cast<off_t> (j) * m_header.width + i0) * sizeof (float);
+            NS_ABORT_MSG_IF (pwrite (fd, &row[0], width * sizeof (float), offset)
+                             != static_cast<ssize_t> (width * sizeof (float)), "Cannot write the REM");
+          }
+      }
+  }
+
+  float
+  Sinr (Vector position)
+  {
+    m_probe->SetPosition (position);
+    double best = 0;
+    double total = 0;
+    for (uint32_t n = 0; n < m_transmitters.size (); ++n)
+      {
+        const Transmitter &t = m_transmitters[n];
+        double rxDbm = m_loss->CalcRxPower (t.txPowerDbm, t.mobility, m_probe) + m_gainDb;
+        if (t.antenna != 0)
+          {
+            rxDbm += t.antenna->GetGainDb (Angles (position, t.mobility->GetPosition ()));
+          }
+        double rxMw = std::pow (10.0, rxDbm / 10);
+        best = std::max (best, rxMw);
+        total += rxMw;
+      }
+    double noiseMw = std::pow (10.0, m_noiseDbm / 10);
+    return 10 * std::log10 (best / (noiseMw + total - best));
+  }
+
+  static std::vector<float>
+  Read (std::string rasterFile, Header &h)
+  {
+    std::ifstream in (rasterFile.c_str (), std::ios::binary);
+    in.read (reinterpret_cast<char *> (&h), sizeof (h));
+    NS_ABORT_MSG_IF (!in || std::memcmp (h.magic, "REM1", 4) != 0, rasterFile << " is not a REM raster");
+    std::vector<float> sinr (static_cast<uint64_t> (h.width) * h.height);
+    in.read (reinterpret_cast<char *> (&sinr[0]), sinr.size () * sizeof (float));
+    NS_ABORT_MSG_IF (!in, rasterFile << " is truncated");
+    return sinr;
+  }
+
+  Header m_header;
+  double m_z;
+  double m_noiseDbm;
+  double m_gainDb;
+  std::vector<Transmitter> m_transmitters;
+  Ptr<PropagationLossModel> m_loss;
+  Ptr<MobilityModel> m_probe;
+};
+
+} // namespace ns3
+
+#endif /* REM_TILES_H */
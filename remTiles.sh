@@ -0,0 +1,19 @@
+#!/bin/sh
+# Downlink SINR maps of the walk area and of the train corridor, for LTE
+# and mmWave. Run from the 'ns3-mmwave' folder, like './waf --run'. Each
+# map is written as REM<scenario>.rem (raster), .csv and .pgm (image).
+#
+#   sh scratch/remTiles.sh
+#   TECHS="mmwave" AREAS="walk" WORKERS=8 sh scratch/remTiles.sh
+
+TECHS=${TECHS:-"lte mmwave"}
+AREAS=${AREAS:-"walk train"}
+WORKERS=${WORKERS:-0}
+TILE_SIZE=${TILE_SIZE:-64}
+
+for tech in $TECHS; do
+  for area in $AREAS; do
+    echo "RemTiles --tech=$tech --area=$area"
+    ./waf --run "scratch/RemTiles --tech=$tech --area=$area --workers=$WORKERS --tileSize=$TILE_SIZE" || exit 1
+  done
+done
@@ -0,0 +1,212 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//Latency under load: round trip time of small UDP probes from a UE to an
+//echo server, while the link is idle and while a saturating TCP flow runs
+//on the same UE.
+//
+//Every probe carries a SeqTsHeader, which the UdpEchoServer sends back
+//untouched, so the RTT of each one is exact and a lost probe is simply
+//never answered. The probes of each phase go in a histogram of 0.1 ms
+//bins. The responsiveness is the round trips per minute (RPM) the loaded
+//link allows, 60 s over the mean loaded RTT, as in the IETF responsiveness
+//test. Every answered probe is written to the CSV:
+//  time_s,phase,seq,rttMs
+
+#ifndef RESPONSIVENESS_H
+#define RESPONSIVENESS_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/seq-ts-header.h"
+
+#include "flow-metrics.h"
+#include "epc-topology.h"
+
+#include <fstream>
+#include <iostream>
+#include <map>
+
+namespace ns3 {
+
+class ResponsivenessProbe
+{
+public:
+  //Probes of size bytes every interval, the load starts at loadStart,
+  //Time::Max () for idle probes only
+  ResponsivenessProbe (std::string filename, Time interval, uint32_t size, Time loadStart)
+    : m_filename (filename),
+      m_interval (interval),
+      m_size (size),
+      m_loadStart (loadStart),
+      m_seq (0),
+      m_loadedSum (0),
+      m_idle (1e-4),
+      m_loaded (1e-4)
+  {
+    m_sent[0] = 0;
+    m_sent[1] = 0;
+    m_answered[0] = 0;
+    m_answered[1] = 0;
+    NS_ABORT_MSG_IF (interval <= Time (0), "The probe interval must be positive");
+    NS_ABORT_MSG_IF (size < SeqTsHeader ().GetSerializedSize (), "A probe must hold a SeqTsHeader");
+  }
+
+  //Draw every gap between probes from an exponential of mean interval, so
+  //the probes find the link in any state
+  void
+  SetExponentialGaps ()
+  {
+    m_gaps = CreateObject<ExponentialRandomVariable> ();
+  }
+
+  //Echo server on the server, probing from the UE between start and stop
+  void
+  Install (Ptr<Node> ue, Ptr<Node> server, Address serverAddress, uint16_t port, Time start, Time stop)
+  {
+    UdpEchoServerHelper echo (port);
+    echo.Install (server).Start (Seconds (0.0));
+
+    m_out.open (m_filename.c_str ());
+    m_out << "time_s,phase,seq,rttMs\n";
+    m_socket = Socket::CreateSocket (ue, UdpSocketFactory::GetTypeId ());
+    m_socket->Bind (AnySocketAddress (!Ipv4Address::IsMatchingType (serverAddress), 0));
+    m_socket->Connect (SocketAddress (serverAddress, port));
+    m_socket->SetRecvCallback (MakeCallback (&ResponsivenessProbe::Receive, this));
+    m_stop = stop;
+    Simulator::Schedule (start, &ResponsivenessProbe::Send, this);
+  }
+
+  void
+  Print (std::ostream &os = std::cout, std::string title = "Responsiveness") const
+  {
+    os << title << " (" << m_sent[0] + m_sent[1] << (m_gaps ? " probes a mean " : " probes ")
+       << m_interval.GetMilliSeconds () << " ms apart)\n";
+    PrintPhase (os, "Idle", m_idle, m_sent[0], m_answered[0]);
+    if (m_sent[1] == 0)
+      {
+        return;
+      }
+    PrintPhase (os, "Loaded", m_loaded, m_sent[1], m_answered[1]);
+    os << " Latency under load: +" << 1e3 * (GetRtt (true, 0.5) - GetRtt (false, 0.5)) << " ms median\n";
+    os << " Responsiveness: " << GetRpm () << " RPM\n";
+  }
+
+  //Fraction q (0..1) percentile of the idle or loaded RTT [s]
+  double
+  GetRtt (bool loaded, double q) const
+  {
+    return HistogramPercentile (loaded ? m_loaded : m_idle, q);
+  }
+
+  //Round trips per minute under load, 0 if no loaded probe came back
+  double
+  GetRpm () const
+  {
+    double mean = SafeRatio (m_loadedSum, m_answered[1]);
+    return mean > 0 ? 60.0 / mean : 0.0;
+  }
+
+private:
+  bool
+  Loaded () const
+  {
+    return Simulator::Now () >= m_loadStart;
+  }
+
+  void
+  Send ()
+  {
+    if (Simulator::Now () >= m_stop)
+      {
+        return;
+      }
+    SeqTsHeader header;
+    header.SetSeq (m_seq++);
+    Ptr<Packet> probe = Create<Packet> (m_size - header.GetSerializedSize ());
+    probe->AddHeader (header);
+    m_socket->Send (probe);
+    m_sent[Loaded ()]++;
+    m_phase[header.GetSeq ()] = Loaded ();
+    Time gap = m_gaps ? Seconds (m_gaps->GetValue (m_interval.GetSeconds (), 0)) : m_interval;
+    Simulator::Schedule (gap, &ResponsivenessProbe::Send, this);
+  }
+
+  void
+  Receive (Ptr<Socket> socket)
+  {
+    Ptr<Packet> packet;
+    while ((packet = socket->Recv ()))
+      {
+        SeqTsHeader header;
+        packet->RemoveHeader (header);
+        std::map<uint32_t, bool>::iterator phase = m_phase.find (header.GetSeq ());
+        if (phase == m_phase.end ())
+          {
+            continue;
+          }
+        //the phase the probe was sent in
+        double rtt = (Simulator::Now () - header.GetTs ()).GetSeconds ();
+        if (phase->second)
+          {
+            m_loaded.AddValue (rtt);
+            m_loadedSum += rtt;
+          }
+        else
+          {
+            m_idle.AddValue (rtt);
+          }
+        m_answered[phase->second]++;
+        m_out << Simulator::Now ().GetSeconds () << "," << (phase->second ? "loaded" : "idle") << ","
+              << header.GetSeq () << "," << 1e3 * rtt << "\n";
+        m_phase.erase (phase);
+      }
+  }
+
+  static void
+  PrintPhase (std::ostream &os, std::string name, const Histogram &h, uint32_t sent, uint32_t answered)
+  {
+    os << " " << name << ": " << answered << " of " << sent << " answered";
+    if (answered > 0)
+      {
+        os << ", RTT p50 " << 1e3 * HistogramPercentile (h, 0.5) << " ms, p90 " << 1e3 * HistogramPercentile (h, 0.9)
+           << " ms, p99 " << 1e3 * HistogramPercentile (h, 0.99) << " ms";
+      }
+    os << "\n";
+  }
+
+  std::string m_filename;
+  Time m_interval;
+  uint32_t m_size;
+  Time m_loadStart;
+  Time m_stop;
+  uint32_t m_seq;
+  uint32_t m_sent[2]; //idle, loaded
+  uint32_t m_answered[2];
+  double m_loadedSum;
+  Histogram m_idle;
+  Histogram m_loaded;
+  std::map<uint32_t, bool> m_phase; //unanswered probes, true if sent under load
+  Ptr<Socket> m_socket;
+  Ptr<ExponentialRandomVariable> m_gaps; //0 for a fixed interval
+  std::ofstream m_out;
+};
+
+} // namespace ns3
+
+#endif /* RESPONSIVENESS_H */
@@ -0,0 +1,349 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//RLC mode and transmit buffer of the data radio bearers, and how full the
+//RLC transmit queues get.
+//
+//Neither RLC exposes its buffer, so the queue of every bearer is counted
+//at the sender: PDCP PDUs handed to RLC (PDCP TxPDU) in, RLC PDUs handed
+//to the MAC (RLC TxPDU) out, and an SDU that would overflow the transmit
+//buffer is dropped as RLC does. Retransmissions and RLC headers make it an
+//estimate, kept within 0 and the buffer size. The sojourn time of an SDU
+//in RLC comes from the timestamps the stack already carries, see
+//bearer-trace.h. One CSV record per bearer and window:
+//  time_s,direction,enbNode,rnti,lcid,bufferBytes,peakBytes,sojournMeanMs,sojournMaxMs,drops
+
+#ifndef RLC_QUEUE_STATS_H
+#define RLC_QUEUE_STATS_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/lte-module.h"
+#include "ns3/histogram.h"
+
+#include "bearer-trace.h"
+#include "flow-metrics.h"
+#include "sweep-file.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <map>
+
+namespace ns3 {
+
+//Set an attribute default only where this ns-3 version has it
+inline bool
+SetDefaultIfPresent (std::string type, std::string attribute, const AttributeValue &value)
+{
+  TypeId tid;
+  TypeId::AttributeInformation info;
+  if (!TypeId::LookupByNameFailSafe (type, &tid) || !tid.LookupAttributeByName (attribute, &info))
+    {
+      return false;
+    }
+  Config::SetDefault (type + "::" + attribute, value);
+  return true;
+}
+
+//Initial value of an unsigned attribute, 0 where this ns-3 version lacks it
+inline uint32_t
+UintegerDefault (std::string type, std::string attribute)
+{
+  TypeId tid;
+  TypeId::AttributeInformation info;
+  if (!TypeId::LookupByNameFailSafe (type, &tid) || !tid.LookupAttributeByName (attribute, &info))
+    {
+      return 0;
+    }
+  return DynamicCast<const UintegerValue> (info.initialValue)->Get ();
+}
+
+//RLC mode of every bearer set up from now on: default (what the helper
+//picks), um or am, and the transmit buffer of every RLC entity that
+//has one, 0 to keep the default. Call after the eNB devices are installed,
+//the mmWave helper sets the mode of its eNBs when installing them. Returns
+//the transmit buffer the queues are bounded by, 0 if they are not.
+inline uint32_t
+ConfigureRlc (std::string mode, uint32_t maxTxBufferBytes)
+{
+  //LteRlcSm discards the data it is given, only the EPC-less saturation
+  //tests use it
+  NS_ABORT_MSG_IF (mode == "sm", "RLC SM drops the traffic of the EPC bearers, use default, um or am");
+  NS_ABORT_MSG_IF (mode != "default" && mode != "um" && mode != "am",
+                   "Unknown RLC mode " << mode << ", use default, um or am");
+  if (mode != "default")
+    {
+      LteEnbRrc::LteEpsBearerToRlcMapping_t mapping = mode == "um" ? LteEnbRrc::RLC_UM_ALWAYS
+        : LteEnbRrc::RLC_AM_ALWAYS;
+      Config::SetDefault ("ns3::LteEnbRrc::EpsBearerToRlcMapping", EnumValue (mapping));
+      Config::Set ("/NodeList/*/DeviceList/*/LteEnbRrc/EpsBearerToRlcMapping", EnumValue (mapping));
+    }
+  //older AM entities buffer without a limit
+  bool amBounded = SetDefaultIfPresent ("ns3::LteRlcAm", "MaxTxBufferSize",
+                                        UintegerValue (maxTxBufferBytes > 0 ? maxTxBufferBytes
+                                                       : UintegerDefault ("ns3::LteRlcAm", "MaxTxBufferSize")));
+  if (maxTxBufferBytes > 0)
+    {
+      Config::SetDefault ("ns3::LteRlcUm::MaxTxBufferSize", UintegerValue (maxTxBufferBytes));
+      SetDefaultIfPresent ("ns3::LteRlcUmLowLat", "MaxTxBufferSize", UintegerValue (maxTxBufferBytes));
+    }
+  else
+    {
+      maxTxBufferBytes = UintegerDefault ("ns3::LteRlcUm", "MaxTxBufferSize");
+    }
+  return mode == "am" && !amBounded ? 0 : maxTxBufferBytes;
+}
+
+class RlcQueueStats
+{
+public:
+  //Nothing is recorded until Install is called, maxTxBufferBytes 0 for an
+  //unbounded buffer
+  RlcQueueStats (std::string filename, Time window, uint32_t maxTxBufferBytes)
+    : m_filename (filename),
+      m_window (window),
+      m_maxTxBufferBytes (maxTxBufferBytes)
+  {
+  }
+
+  //The bearers only exist once the UEs have attached, so they are hooked
+  //at connectAt
+  void
+  Install (Time connectAt)
+  {
+    NS_ABORT_MSG_IF (m_window <= Time (0), "The RLC queue window must be positive");
+    m_out.open (m_filename.c_str ());
+    m_out << "time_s,direction,enbNode,rnti,lcid,bufferBytes,peakBytes,sojournMeanMs,sojournMaxMs,drops\n";
+    Simulator::Schedule (connectAt, &RlcQueueStats::Connect, this);
+    Simulator::Schedule (m_window, &RlcQueueStats::Flush, this);
+  }
+
+  //Write the last, partial, window and a summary per bearer
+  void
+  Finish (std::ostream &os = std::cout)
+  {
+    if (!m_out.is_open ())
+      {
+        return;
+      }
+    Write ();
+    m_out.flush ();
+    os << "RLC queues (transmit buffer " << m_maxTxBufferBytes << " bytes)\n";
+    for (std::map<uint64_t, Queue>::const_iterator it = m_queues.begin (); it != m_queues.end (); ++it)
+      {
+        const Queue &q = it->second;
+        os << " " << (BearerUplink (it->first) ? "UL" : "DL") << " eNB node " << BearerEnbNode (it->first)
+           << " RNTI " << BearerRnti (it->first)
+           << " LCID " << BearerLcid (it->first) << ": peak " << q.peak << " bytes, sojourn "
+           << 1e3 * SafeRatio (q.sojournSum, q.sojourns) << " ms mean, "
+           << 1e3 * HistogramPercentile (q.sojourn, 0.95) << " ms p95, " << q.drops << " SDUs dropped\n";
+      }
+  }
+
+  //Mean and 95th percentile sojourn [ms], highest peak [bytes] and drops
+  //over every bearer
+  void
+  GetTotals (double &meanMs, double &p95Ms, uint64_t &peakBytes, uint64_t &drops) const
+  {
+    Histogram all (1e-4);
+    double sum = 0;
+    uint64_t n = 0;
+    peakBytes = 0;
+    drops = 0;
+    for (std::map<uint64_t, Queue>::const_iterator it = m_queues.begin (); it != m_queues.end (); ++it)
+      {
+        AddHistogram (all, it->second.sojourn);
+        sum += it->second.sojournSum;
+        n += it->second.sojourns;
+        peakBytes = std::max (peakBytes, it->second.peak);
+        drops += it->second.drops;
+      }
+    meanMs = 1e3 * SafeRatio (sum, n);
+    p95Ms = 1e3 * HistogramPercentile (all, 0.95);
+  }
+
+private:
+  struct Queue
+  {
+    Queue ()
+      : bytes (0), peak (0), drops (0), lastRlcNs (0), sojourn (1e-4), sojournSum (0), sojourns (0),
+        windowPeak (0), windowSum (0), windowMax (0), windowN (0), windowDrops (0)
+    {
+    }
+    uint64_t bytes;
+    uint64_t peak;
+    uint64_t drops;
+    uint64_t lastRlcNs;  //RLC delay of the last PDU received
+    Histogram sojourn;   //whole run, 0.1 ms bins
+    double sojournSum;
+    uint64_t sojourns;
+    uint64_t windowPeak;
+    double windowSum;
+    double windowMax;
+    uint64_t windowN;
+    uint64_t windowDrops;
+  };
+
+  void
+  Connect ()
+  {
+    //downlink queues are at the eNBs, uplink ones at the UEs, and the
+    //delays are read at the other end
+    m_enbByCell = EnbNodeByCell ();
+    std::string enb = "/NodeList/*/DeviceList/*/LteEnbRrc/UeMap/*/DataRadioBearerMap/*/";
+    Config::Connect (enb + "LtePdcp/TxPDU", MakeBoundCallback (&RlcQueueStats::EnbTx, this, true));
+    Config::Connect (enb + "LteRlc/TxPDU", MakeBoundCallback (&RlcQueueStats::EnbTx, this, false));
+    Config::Connect (enb + "LteRlc/RxPDU", MakeBoundCallback (&RlcQueueStats::EnbRx, this, false));
+    Config::Connect (enb + "LtePdcp/RxPDU", MakeBoundCallback (&RlcQueueStats::EnbRx, this, true));
+    std::vector<std::string> paths = UeRrcPaths ("*");
+    for (uint32_t n = 0; n < paths.size (); ++n)
+      {
+        Config::MatchContainer rrcs = Config::LookupMatches (paths[n]);
+        for (uint32_t r = 0; r < rrcs.GetN (); ++r)
+          {
+            Ptr<LteUeRrc> rrc = rrcs.Get (r)->GetObject<LteUeRrc> ();
+            std::string ue = rrcs.GetMatchedPath (r) + "/DataRadioBearerMap/*/";
+            Config::ConnectWithoutContext (ue + "LtePdcp/TxPDU",
+                                           MakeBoundCallback (&RlcQueueStats::UeTx, this, true, rrc));
+            Config::ConnectWithoutContext (ue + "LteRlc/TxPDU",
+                                           MakeBoundCallback (&RlcQueueStats::UeTx, this, false, rrc));
+            Config::ConnectWithoutContext (ue + "LteRlc/RxPDU",
+                                           MakeBoundCallback (&RlcQueueStats::UeRx, this, false, rrc));
+            Config::ConnectWithoutContext (ue + "LtePdcp/RxPDU",
+                                           MakeBoundCallback (&RlcQueueStats::UeRx, this, true, rrc));
+          }
+      }
+  }
+
+  //PDCP TxPDU (pdcp) or RLC TxPDU at an eNB, a downlink queue
+  static void
+  EnbTx (RlcQueueStats *stats, bool pdcp, std::string context, uint16_t rnti, uint8_t lcid, uint32_t size)
+  {
+    stats->Tx (pdcp, BearerKey (ContextNode (context), false, rnti, lcid), size);
+  }
+
+  static void
+  EnbRx (RlcQueueStats *stats, bool pdcp, std::string context, uint16_t rnti, uint8_t lcid, uint32_t size,
+         uint64_t delayNs)
+  {
+    stats->Rx (pdcp, BearerKey (ContextNode (context), true, rnti, lcid), delayNs);
+  }
+
+  //At a UE the serving eNB is the one of the cell its RRC is attached to
+  static void
+  UeTx (RlcQueueStats *stats, bool pdcp, Ptr<LteUeRrc> rrc, uint16_t rnti, uint8_t lcid, uint32_t size)
+  {
+    stats->Tx (pdcp, BearerKey (stats->m_enbByCell[rrc->GetCellId ()], true, rnti, lcid), size);
+  }
+
+  static void
+  UeRx (RlcQueueStats *stats, bool pdcp, Ptr<LteUeRrc> rrc, uint16_t rnti, uint8_t lcid, uint32_t size,
+        uint64_t delayNs)
+  {
+    stats->Rx (pdcp, BearerKey (stats->m_enbByCell[rrc->GetCellId ()], false, rnti, lcid), delayNs);
+  }
+
+  //An SDU into RLC (pdcp) or a PDU out of it, at the sender
+  void
+  Tx (bool pdcp, uint64_t key, uint32_t size)
+  {
+    Queue &q = m_queues[key];
+    if (!pdcp)
+      {
+        q.bytes -= std::min<uint64_t> (q.bytes, size);
+        return;
+      }
+    if (m_maxTxBufferBytes > 0 && q.bytes + size > m_maxTxBufferBytes)
+      {
+        q.drops++;
+        q.windowDrops++;
+        return;
+      }
+    q.bytes += size;
+    q.peak = std::max (q.peak, q.bytes);
+    q.windowPeak = std::max (q.windowPeak, q.bytes);
+  }
+
+  //An SDU out of PDCP (pdcp) or a PDU out of RLC, at the receiver
+  void
+  Rx (bool pdcp, uint64_t key, uint64_t delayNs)
+  {
+    Queue &q = m_queues[key];
+    if (!pdcp)
+      {
+        q.lastRlcNs = delayNs;
+        return;
+      }
+    double sojourn = RlcSojourn (delayNs, q.lastRlcNs);
+    q.sojourn.AddValue (sojourn);
+    q.sojournSum += sojourn;
+    q.sojourns++;
+    q.windowSum += sojourn;
+    q.windowMax = std::max (q.windowMax, sojourn);
+    q.windowN++;
+  }
+
+  void
+  Flush ()
+  {
+    Write ();
+    Simulator::Schedule (m_window, &RlcQueueStats::Flush, this);
+  }
+
+  void
+  Write ()
+  {
+    for (std::map<uint64_t, Queue>::iterator it = m_queues.begin (); it != m_queues.end (); ++it)
+      {
+        Queue &q = it->second;
+        m_out << Simulator::Now ().GetSeconds () << "," << (BearerUplink (it->first) ? "UL" : "DL") << ","
+              << BearerEnbNode (it->first) << "," << BearerRnti (it->first) << "," << BearerLcid (it->first) << ","
+              << q.bytes << "," << std::max (q.windowPeak, q.bytes) << "," << 1e3 * SafeRatio (q.windowSum, q.windowN)
+              << "," << 1e3 * q.windowMax << "," << q.windowDrops << "\n";
+        q.windowPeak = q.bytes;
+        q.windowSum = 0;
+        q.windowMax = 0;
+        q.windowN = 0;
+        q.windowDrops = 0;
+      }
+  }
+
+  std::string m_filename;
+  Time m_window;
+  uint32_t m_maxTxBufferBytes;
+  std::ofstream m_out;
+  std::map<uint16_t, uint32_t> m_enbByCell; //eNB node of each cell id
+  std::map<uint64_t, Queue> m_queues; //by BearerKey
+};
+
+//Append one line per run to a sweep CSV, see sweep-file.h
+inline void
+AppendRlcSweep (std::string filename, std::string mode, uint32_t maxTxBufferBytes, double goodputMbps,
+                const RlcQueueStats &stats)
+{
+  std::ofstream sweep;
+  OpenSweepFile (sweep, filename, "mode,bufferBytes,goodputMbps,sojournMeanMs,sojournP95Ms,peakBytes,drops");
+  double meanMs, p95Ms;
+  uint64_t peakBytes, drops;
+  stats.GetTotals (meanMs, p95Ms, peakBytes, drops);
+  sweep << mode << "," << maxTxBufferBytes << "," << goodputMbps << "," << meanMs << "," << p95Ms << ","
+        << peakBytes << "," << drops << "\n";
+}
+
+} // namespace ns3
+
+#endif /* RLC_QUEUE_STATS_H */
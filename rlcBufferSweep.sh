@@ -0,0 +1,26 @@
+#!/bin/sh
+# Sweep the RLC mode and transmit buffer under a bulk TCP upload and a UDP
+# stream on one mmWave UE (mmwaveMixedTraffic). Run from the 'ns3-mmwave'
+# folder, like './waf --run'. Every run appends one line (throughput, RLC
+# sojourn mean and p95, peak queue, drops) to $SWEEP_FILE, the buffer that
+# keeps the sojourn low at full throughput is the one to pick.
+#
+#   sh scratch/rlcBufferSweep.sh
+#   MODES="um" BUFFERS="10240 102400" sh scratch/rlcBufferSweep.sh
+
+SIM_TIME=${SIM_TIME:-4}
+TCP_RATE=${TCP_RATE:-2Gbps}
+SWEEP_FILE=${SWEEP_FILE:-RlcSweepmmwaveMixedTraffic.csv}
+
+MODES=${MODES:-"um am"}
+# bytes, from a few packets to a bufferbloated 10MB
+BUFFERS=${BUFFERS:-"10240 102400 1048576 10485760"}
+
+for mode in $MODES; do
+  for buffer in $BUFFERS; do
+    echo "mmwaveMixedTraffic --rlcMode=$mode --rlcBuffer=$buffer"
+    ./waf --run "scratch/mmwaveMixedTraffic --simTime=$SIM_TIME --profile=tcp,udp --tcpRate=$TCP_RATE --appBearers=false --rlcSweepFile=$SWEEP_FILE --rlcMode=$mode --rlcBuffer=$buffer" > /dev/null || exit 1
+  done
+done
+
+echo "Results in $SWEEP_FILE"
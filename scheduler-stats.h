@@ -0,0 +1,235 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//LTE MAC scheduler selection and what each one delivers.
+//
+//The scheduler is picked by short name (pf, rr, tdmt, ...). SchedulerStats
+//adds up the downlink TBs every eNB MAC schedules, per UE (IMSI, so a UE
+//handed over between eNBs stays one UE), which gives the scheduled cell
+//throughput and Jain's fairness index over the UEs attached to the eNBs,
+//including background UEs the flow monitor does not see and UEs that were
+//never scheduled. The DlScheduling trace does not tell new data from HARQ
+//retransmissions, so the throughput is what was scheduled, not delivered. The
+//schedulers cannot be timed on their own from a scenario, so the cost is
+//the wall clock time of Simulator::Run divided by the TTIs simulated;
+//comparing runs that only differ in scheduler gives its share.
+
+#ifndef SCHEDULER_STATS_H
+#define SCHEDULER_STATS_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/lte-module.h"
+#include "ns3/system-wall-clock-ms.h"
+
+#include "flow-metrics.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <vector>
+
+namespace ns3 {
+
+//TypeId of an LTE FF MAC scheduler from its short name
+inline std::string
+LteSchedulerType (std::string name)
+{
+  const char *names[][2] = {
+    {"pf", "ns3::PfFfMacScheduler"},       //proportional fair (LteHelper default)
+    {"rr", "ns3::RrFfMacScheduler"},       //round robin
+    {"tdmt", "ns3::TdMtFfMacScheduler"},   //time domain maximum throughput
+    {"fdmt", "ns3::FdMtFfMacScheduler"},   //frequency domain maximum throughput
+    {"tta", "ns3::TtaFfMacScheduler"},     //throughput to average
+    {"tdbet", "ns3::TdBetFfMacScheduler"}, //time domain blind equal throughput
+    {"fdbet", "ns3::FdBetFfMacScheduler"}, //frequency domain blind equal throughput
+    {"tdtbfq", "ns3::TdTbfqFfMacScheduler"}, //token bank fair queue
+    {"fdtbfq", "ns3::FdTbfqFfMacScheduler"},
+    {"pss", "ns3::PssFfMacScheduler"},     //priority set
+    {"cqa", "ns3::CqaFfMacScheduler"}      //channel and QoS aware
+  };
+  for (uint32_t n = 0; n < sizeof (names) / sizeof (names[0]); ++n)
+    {
+      if (name == names[n][0])
+        {
+          return names[n][1];
+        }
+    }
+  NS_FATAL_ERROR ("Unknown scheduler " << name << ", use pf, rr, tdmt, fdmt, tta, tdbet, fdbet, tdtbfq, fdtbfq, pss or cqa");
+  return "";
+}
+
+//PRBs of the smallest downlink allocation whose TB at this MCS holds
+//tbBytes, the DlScheduling trace gives the TB but not the allocation
+inline uint16_t
+DlPrbsFromTb (Ptr<LteAmc> amc, uint8_t mcs, uint32_t tbBytes, uint16_t maxPrbs)
+{
+  uint16_t nprb = 1;
+  while (nprb < maxPrbs && amc->GetDlTbSizeFromMcs (mcs, nprb) / 8 < static_cast<int> (tbBytes))
+    {
+      nprb++;
+    }
+  return nprb;
+}
+
+//Peak downlink rate of one LTE carrier of this many RBs, single layer at
+//the highest MCS
+inline double
+LtePeakDlMbps (uint16_t rbs)
+{
+  Ptr<LteAmc> amc = CreateObject<LteAmc> ();
+  return amc->GetDlTbSizeFromMcs (28, rbs) / 1e3;
+}
+
+class SchedulerStats
+{
+public:
+  SchedulerStats (std::string scheduler)
+    : m_scheduler (scheduler),
+      m_numCarriers (0),
+      m_wallMs (0)
+  {
+  }
+
+  //Hook the DlScheduling trace of every eNB MAC, counting from start, and
+  //the RRC of every eNB for the UEs attached to it
+  void
+  Install (NetDeviceContainer enbDevs, Time start)
+  {
+    m_start = start;
+    for (uint32_t e = 0; e < enbDevs.GetN (); ++e)
+      {
+        m_numCarriers += enbDevs.Get (e)->GetObject<LteEnbNetDevice> ()->GetCcMap ().size ();
+      }
+    Config::Connect ("/NodeList/*/DeviceList/*/ComponentCarrierMap/*/LteEnbMac/DlScheduling",
+                     MakeCallback (&SchedulerStats::DlScheduling, this));
+    Config::Connect ("/NodeList/*/DeviceList/*/LteEnbRrc/ConnectionEstablished",
+                     MakeCallback (&SchedulerStats::UeAttached, this));
+    Config::Connect ("/NodeList/*/DeviceList/*/LteEnbRrc/HandoverEndOk",
+                     MakeCallback (&SchedulerStats::UeAttached, this));
+  }
+
+  //Time Simulator::Run with these around it
+  void
+  StartClock ()
+  {
+    m_clock.Start ();
+  }
+
+  void
+  StopClock ()
+  {
+    m_wallMs = m_clock.End ();
+  }
+
+  //Downlink throughput scheduled by the cells in Mbps, retransmissions
+  //included
+  double
+  GetScheduledMbps () const
+  {
+    uint64_t bytes = 0;
+    for (std::map<uint64_t, uint64_t>::const_iterator u = m_ueBytes.begin (); u != m_ueBytes.end (); ++u)
+      {
+        bytes += u->second;
+      }
+    return GoodputMbps (bytes, (Simulator::Now () - m_start).GetSeconds ());
+  }
+
+  //Jain's index over the downlink throughput of the attached UEs
+  double
+  GetJainIndex () const
+  {
+    std::vector<double> rates;
+    for (std::map<uint64_t, uint64_t>::const_iterator u = m_ueBytes.begin (); u != m_ueBytes.end (); ++u)
+      {
+        rates.push_back (u->second);
+      }
+    return JainIndex (rates);
+  }
+
+  //Wall clock time per simulated TTI of one carrier, in microseconds
+  double
+  GetWallUsPerTti () const
+  {
+    return SafeRatio (m_wallMs * 1e3, Simulator::Now ().GetMilliSeconds () * m_numCarriers);
+  }
+
+  void
+  Print (std::ostream &os = std::cout) const
+  {
+    os << "Scheduler " << m_scheduler << " (" << LteSchedulerType (m_scheduler) << ")\n";
+    os << " UEs attached: " << m_ueBytes.size () << ", scheduled: " << GetScheduledUes () << "\n";
+    os << " Cell DL Scheduled Throughput: " << GetScheduledMbps () << " Mbps (HARQ retransmissions included)\n";
+    os << " Jain's Fairness Index: " << GetJainIndex () << "\n";
+    os << " Wall Clock: " << m_wallMs << " ms (" << GetWallUsPerTti () << " us per TTI)\n";
+  }
+
+private:
+  //the same RNTI on every carrier of an eNB is the same UE
+  static uint64_t
+  RntiKey (std::string context, uint16_t rnti)
+  {
+    uint64_t nodeId = atoi (context.substr (10, context.find ('/', 10) - 10).c_str ());
+    return (nodeId << 16) | rnti;
+  }
+
+  uint32_t
+  GetScheduledUes () const
+  {
+    uint32_t n = 0;
+    for (std::map<uint64_t, uint64_t>::const_iterator u = m_ueBytes.begin (); u != m_ueBytes.end (); ++u)
+      {
+        n += u->second > 0;
+      }
+    return n;
+  }
+
+  //A UE that is never scheduled still counts, with 0 bytes. A reused RNTI
+  //is taken over by the UE that connects or is handed over with it.
+  void
+  UeAttached (std::string context, uint64_t imsi, uint16_t cellId, uint16_t rnti)
+  {
+    m_imsiByRnti[RntiKey (context, rnti)] = imsi;
+    m_ueBytes[imsi] += 0;
+  }
+
+  void
+  DlScheduling (std::string context, DlSchedulingCallbackInfo info)
+  {
+    if (Simulator::Now () < m_start)
+      {
+        return;
+      }
+    //TBs before the RRC connection is set up carry no user data
+    std::map<uint64_t, uint64_t>::const_iterator it = m_imsiByRnti.find (RntiKey (context, info.rnti));
+    if (it != m_imsiByRnti.end ())
+      {
+        m_ueBytes[it->second] += info.sizeTb1 + info.sizeTb2;
+      }
+  }
+
+  std::string m_scheduler;
+  Time m_start;
+  uint32_t m_numCarriers;
+  SystemWallClockMs m_clock;
+  int64_t m_wallMs;
+  std::map<uint64_t, uint64_t> m_imsiByRnti; //node id << 16 | rnti -> IMSI
+  std::map<uint64_t, uint64_t> m_ueBytes; //by IMSI
+};
+
+} // namespace ns3
+
+#endif /* SCHEDULER_STATS_H */
@@ -0,0 +1,213 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//Queue discipline on both ends of the PGW-server link, and what its
+//queues hold.
+//
+//aqm is none (the pfifo_fast the address helper installs), fqcodel, pie or
+//red. The device queues are cut to one packet in every mode, so packets
+//wait in the queue disc where the AQM, and the samples, can see them.
+//Every interval the queue of each end is sampled into one CSV record:
+//  time_s,direction,packets,bytes,sojournMeanMs,sojournMaxMs,dropsPerS
+//DL is the server end, UL the PGW end. The sojourn is that of the packets
+//dequeued in the interval.
+
+#ifndef SERVER_AQM_H
+#define SERVER_AQM_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/traffic-control-module.h"
+#include "ns3/epc-helper.h"
+
+#include "flow-metrics.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+namespace ns3 {
+
+class ServerAqm
+{
+public:
+  ServerAqm (std::string aqm)
+    : m_aqm (aqm)
+  {
+    NS_ABORT_MSG_IF (aqm != "none" && aqm != "fqcodel" && aqm != "pie" && aqm != "red",
+                     "Unknown AQM " << aqm << ", use none, fqcodel, pie or red");
+  }
+
+  //Put the queue disc on the link between the PGW and the server, call
+  //after ConnectRemoteHost. interval 0 records nothing.
+  void
+  Install (Ptr<EpcHelper> epcHelper, Ptr<Node> server, std::string filename, Time interval)
+  {
+    Ptr<PointToPointNetDevice> serverDev = 0;
+    Ptr<PointToPointNetDevice> pgwDev = 0;
+    for (uint32_t d = 0; d < server->GetNDevices () && pgwDev == 0; ++d)
+      {
+        serverDev = DynamicCast<PointToPointNetDevice> (server->GetDevice (d));
+        if (serverDev == 0)
+          {
+            continue;
+          }
+        Ptr<Channel> channel = serverDev->GetChannel ();
+        for (uint32_t c = 0; c < channel->GetNDevices (); ++c)
+          {
+            if (channel->GetDevice (c)->GetNode () == epcHelper->GetPgwNode ())
+              {
+                pgwDev = DynamicCast<PointToPointNetDevice> (channel->GetDevice (c));
+              }
+          }
+      }
+    NS_ABORT_MSG_IF (pgwDev == 0, "The server is not connected to the PGW");
+    NetDeviceContainer devices (serverDev, pgwDev);
+
+    if (m_aqm != "none")
+      {
+        TrafficControlHelper tch;
+        if (m_aqm == "fqcodel")
+          {
+            tch.SetRootQueueDisc ("ns3::FqCoDelQueueDisc");
+          }
+        else if (m_aqm == "pie")
+          {
+            tch.SetRootQueueDisc ("ns3::PieQueueDisc");
+          }
+        else
+          {
+            //RED scales its idle time estimate by the link
+            DataRateValue rate;
+            serverDev->GetAttribute ("DataRate", rate);
+            TimeValue delay;
+            serverDev->GetChannel ()->GetAttribute ("Delay", delay);
+            tch.SetRootQueueDisc ("ns3::RedQueueDisc", "LinkBandwidth", rate, "LinkDelay", delay);
+          }
+        tch.Uninstall (devices);
+        tch.Install (devices);
+      }
+    //with none too, or the backlog would sit in the 100 packet device queues
+    serverDev->GetQueue ()->SetMaxSize (QueueSize ("1p"));
+    pgwDev->GetQueue ()->SetMaxSize (QueueSize ("1p"));
+    for (uint32_t d = 0; d < 2; ++d)
+      {
+        Ptr<NetDevice> dev = devices.Get (d);
+        m_ends[d].disc = dev->GetNode ()->GetObject<TrafficControlLayer> ()->GetRootQueueDiscOnDevice (dev);
+      }
+
+    if (interval > Time (0))
+      {
+        m_interval = interval;
+        m_out.open (filename.c_str ());
+        m_out << "time_s,direction,packets,bytes,sojournMeanMs,sojournMaxMs,dropsPerS\n";
+        m_ends[0].disc->TraceConnectWithoutContext ("SojournTime", MakeCallback (&ServerAqm::SojournDl, this));
+        m_ends[1].disc->TraceConnectWithoutContext ("SojournTime", MakeCallback (&ServerAqm::SojournUl, this));
+        Simulator::Schedule (m_interval, &ServerAqm::Sample, this);
+      }
+  }
+
+  void
+  Print (std::ostream &os = std::cout) const
+  {
+    os << "Server link queue disc: " << m_aqm << "\n";
+    const char *names[] = { "DL", "UL" };
+    for (uint32_t d = 0; d < 2; ++d)
+      {
+        const End &e = m_ends[d];
+        if (e.disc == 0)
+          {
+            continue;
+          }
+        QueueDisc::Stats stats = e.disc->GetStats ();
+        os << " " << names[d] << ": " << stats.nTotalSentPackets << " packets sent, "
+           << stats.nTotalDroppedPackets << " dropped, sojourn "
+           << 1e3 * SafeRatio (e.sojournSum, e.sojourns) << " ms mean, " << 1e3 * e.sojournMax << " ms max\n";
+      }
+  }
+
+private:
+  struct End
+  {
+    End ()
+      : disc (0), sojournSum (0), sojourns (0), sojournMax (0), windowSum (0), windowN (0), windowMax (0),
+        lastDrops (0)
+    {
+    }
+    Ptr<QueueDisc> disc;
+    double sojournSum;
+    uint64_t sojourns;
+    double sojournMax;
+    double windowSum;
+    uint64_t windowN;
+    double windowMax;
+    uint32_t lastDrops;
+  };
+
+  static void
+  AddSojourn (End &e, Time sojourn)
+  {
+    double s = sojourn.GetSeconds ();
+    e.sojournSum += s;
+    e.sojourns++;
+    e.sojournMax = std::max (e.sojournMax, s);
+    e.windowSum += s;
+    e.windowN++;
+    e.windowMax = std::max (e.windowMax, s);
+  }
+
+  void
+  SojournDl (Time sojourn)
+  {
+    AddSojourn (m_ends[0], sojourn);
+  }
+
+  void
+  SojournUl (Time sojourn)
+  {
+    AddSojourn (m_ends[1], sojourn);
+  }
+
+  void
+  Sample ()
+  {
+    const char *names[] = { "DL", "UL" };
+    for (uint32_t d = 0; d < 2; ++d)
+      {
+        End &e = m_ends[d];
+        uint32_t drops = e.disc->GetStats ().nTotalDroppedPackets;
+        m_out << Simulator::Now ().GetSeconds () << "," << names[d] << "," << e.disc->GetNPackets () << ","
+              << e.disc->GetNBytes () << "," << 1e3 * SafeRatio (e.windowSum, e.windowN) << ","
+              << 1e3 * e.windowMax << "," << (drops - e.lastDrops) / m_interval.GetSeconds () << "\n";
+        e.lastDrops = drops;
+        e.windowSum = 0;
+        e.windowN = 0;
+        e.windowMax = 0;
+      }
+    Simulator::Schedule (m_interval, &ServerAqm::Sample, this);
+  }
+
+  std::string m_aqm;
+  Time m_interval;
+  std::ofstream m_out;
+  End m_ends[2]; //server end (DL) and PGW end (UL)
+};
+
+} // namespace ns3
+
+#endif /* SERVER_AQM_H */
@@ -0,0 +1,95 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//An edge server next to the PGW and a remote one across a WAN, both
+//behind the same PGW so a UE reaches them over the same radio and bearer.
+//
+//The RTT to the edge server less its own link is what the radio and the
+//EPC cost, the extra RTT to the remote server is what its placement costs.
+
+#ifndef SERVER_PLACEMENT_H
+#define SERVER_PLACEMENT_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/epc-helper.h"
+
+#include "epc-topology.h"
+#include "responsiveness.h"
+
+#include <iostream>
+#include <sstream>
+
+namespace ns3 {
+
+struct ServerPlacement
+{
+  double edgeDelayMs;   //PGW to the edge server
+  std::string edgeRate;
+  double wanDelayMs;    //PGW to the remote server
+  std::string wanRate;
+};
+
+inline ServerPlacement
+DefaultServerPlacement ()
+{
+  ServerPlacement p = { 0.5, "10Gbps", 20.0, "1Gbps" };
+  return p;
+}
+
+//Connect both servers to the PGW, each on its own link and network.
+//Returns the edge server address in edgeAddress and the remote one in
+//remoteAddress.
+inline void
+ConnectServers (Ptr<EpcHelper> epcHelper, Ptr<Node> edge, Ptr<Node> remote, const ServerPlacement &p,
+                Address &edgeAddress, Address &remoteAddress)
+{
+  NS_ABORT_MSG_IF (p.edgeDelayMs < 0 || p.wanDelayMs < 0, "Link delays cannot be negative");
+  PointToPointHelper edgeLink;
+  edgeLink.SetDeviceAttribute ("DataRate", StringValue (p.edgeRate));
+  edgeLink.SetChannelAttribute ("Delay", TimeValue (MicroSeconds (1e3 * p.edgeDelayMs)));
+  edgeAddress = ConnectRemoteHost (epcHelper, edge, edgeLink, false);
+
+  PointToPointHelper wan;
+  wan.SetDeviceAttribute ("DataRate", StringValue (p.wanRate));
+  wan.SetChannelAttribute ("Delay", TimeValue (MicroSeconds (1e3 * p.wanDelayMs)));
+  remoteAddress = ConnectRemoteHost (epcHelper, remote, wan, false);
+}
+
+//RTT of the probes to each server and the split between the radio and
+//core and the server placement, on medians
+inline void
+PrintServerPlacement (const ServerPlacement &p, const ResponsivenessProbe &edge, const ResponsivenessProbe &remote,
+                      std::ostream &os = std::cout)
+{
+  std::ostringstream title;
+  title << "Edge server, " << p.edgeDelayMs << " ms from the PGW";
+  edge.Print (os, title.str ());
+  title.str ("");
+  title << "Remote server, " << p.wanDelayMs << " ms WAN from the PGW";
+  remote.Print (os, title.str ());
+  double edgeMs = 1e3 * edge.GetRtt (false, 0.5);
+  double remoteMs = 1e3 * remote.GetRtt (false, 0.5);
+  os << "Median RTT split\n";
+  os << " Radio and EPC: " << edgeMs - 2 * p.edgeDelayMs << " ms\n";
+  os << " Edge link: " << 2 * p.edgeDelayMs << " ms\n";
+  os << " Remote placement: +" << remoteMs - edgeMs << " ms over the edge server\n";
+}
+
+} // namespace ns3
+
+#endif /* SERVER_PLACEMENT_H */
@@ -0,0 +1,53 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//The sweep CSVs the scenarios append one line per run to. A new file gets
+//the header, an existing one must start with the same header, so runs
+//written with other columns never end up in one table.
+
+#ifndef SWEEP_FILE_H
+#define SWEEP_FILE_H
+
+#include "ns3/core-module.h"
+
+#include <fstream>
+#include <string>
+
+namespace ns3 {
+
+//Open filename for appending, writing header if the file is new or empty.
+//Aborts if the file was written with another header.
+inline void
+OpenSweepFile (std::ofstream &sweep, std::string filename, std::string header)
+{
+  std::ifstream existing (filename.c_str ());
+  std::string existingHeader;
+  bool writeHeader = !std::getline (existing, existingHeader);
+  existing.close ();
+  if (!writeHeader && existingHeader != header)
+    {
+      NS_FATAL_ERROR ("Sweep file " << filename << " has other columns, append to a new file");
+    }
+  sweep.open (filename.c_str (), std::ios::app);
+  if (writeHeader)
+    {
+      sweep << header << "\n";
+    }
+}
+
+} // namespace ns3
+
+#endif /* SWEEP_FILE_H */
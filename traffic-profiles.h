@@ -0,0 +1,270 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//Several applications on one UE, built from the single traffic scenarios:
+//"http" (ThreeGppHttpClient browsing), "voip" (VoipClient call), "tcp"
+//(OnOff background sync) and "udp" (UdpClient stream).
+//
+//Every application gets its own server port, so its flows are tagged by
+//port in the FlowMonitor report and can be put on their own bearer. The
+//server side applications run from the start of the simulation.
+
+#ifndef TRAFFIC_PROFILES_H
+#define TRAFFIC_PROFILES_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/voip-client-server-helper.h"
+
+#include "flow-metrics.h"
+#include "epc-topology.h"
+#include "bearer-config.h"
+
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <vector>
+
+namespace ns3 {
+
+class TrafficProfiles
+{
+public:
+  //One installed application
+  struct App
+  {
+    std::string type;
+    uint32_t ue;   //index of the UE in install order
+    uint16_t port; //port on the server
+  };
+
+  TrafficProfiles (Ptr<Node> server, Address serverAddress, bool useV6)
+    : m_server (server),
+      m_serverAddress (serverAddress),
+      m_useV6 (useV6),
+      m_nextPort (50000),
+      m_numUes (0),
+      m_tcpRate ("5Mbps")
+  {
+  }
+
+  //Data rate of the background TCP sync
+  void
+  SetTcpRate (std::string rate)
+  {
+    m_tcpRate = rate;
+  }
+
+  //Install a profile such as "http,voip,tcp" on a UE, starting at start
+  void
+  Install (std::string profile, Ptr<Node> ue, Time start)
+  {
+    std::replace (profile.begin (), profile.end (), ',', ' ');
+    std::istringstream in (profile);
+    std::string type;
+    while (in >> type)
+      {
+        App app;
+        app.type = type;
+        app.ue = m_numUes;
+        app.port = m_nextPort++;
+        if (type == "http")
+          {
+            InstallHttp (ue, app.port, start);
+          }
+        else if (type == "voip")
+          {
+            InstallVoip (ue, app.port, start);
+          }
+        else if (type == "tcp")
+          {
+            InstallTcp (ue, app.port, start);
+          }
+        else if (type == "udp")
+          {
+            InstallUdp (ue, app.port, start);
+          }
+        else
+          {
+            NS_FATAL_ERROR ("Unknown application " << type << " in profile, use http, voip, tcp or udp");
+          }
+        m_apps.push_back (app);
+      }
+    m_numUes++;
+  }
+
+  const std::vector<App> &
+  GetApps () const
+  {
+    return m_apps;
+  }
+
+  //One dedicated bearer per application with the QCI of its type
+  std::vector<BearerSpec>
+  GetBearers () const
+  {
+    std::vector<BearerSpec> bearers;
+    for (uint32_t a = 0; a < m_apps.size (); ++a)
+      {
+        BearerSpec b = { DefaultQci (m_apps[a].type), m_apps[a].port, m_apps[a].port };
+        bearers.push_back (b);
+      }
+    return bearers;
+  }
+
+  //Flows of each application type merged into one
+  std::map<std::string, FlowMonitor::FlowStats>
+  MergeByType (Ptr<FlowMonitor> flowMonitor, FlowMonitorHelper &flowHelper) const
+  {
+    std::map<std::string, FlowMonitor::FlowStats> perType;
+    FlowMonitor::FlowStatsContainer stats = flowMonitor->GetFlowStats ();
+    for (std::map<FlowId, FlowMonitor::FlowStats>::const_iterator i = stats.begin (); i != stats.end (); ++i)
+      {
+        const App *app = FindApp (FindFlowTuple (flowMonitor, flowHelper, i->first));
+        if (app == 0)
+          {
+            continue;
+          }
+        std::map<std::string, FlowMonitor::FlowStats>::iterator merged = perType.find (app->type);
+        if (merged == perType.end ())
+          {
+            perType[app->type] = i->second;
+          }
+        else
+          {
+            MergeFlowStats (merged->second, i->second);
+          }
+      }
+    return perType;
+  }
+
+  //Flows tagged with their application, then one line per application type
+  //with all its flows merged
+  void
+  Print (Ptr<FlowMonitor> flowMonitor, FlowMonitorHelper &flowHelper, std::ostream &os = std::cout) const
+  {
+    FlowMonitor::FlowStatsContainer stats = flowMonitor->GetFlowStats ();
+    for (std::map<FlowId, FlowMonitor::FlowStats>::const_iterator i = stats.begin (); i != stats.end (); ++i)
+      {
+        FlowTuple t = FindFlowTuple (flowMonitor, flowHelper, i->first);
+        const App *app = FindApp (t);
+        os << "Flow " << i->first << " (" << t << ")";
+        if (app != 0)
+          {
+            os << " [" << app->type << ", UE " << app->ue << ", port " << app->port << "]";
+          }
+        os << "\n";
+        PrintFlowMetrics (os, ComputeFlowMetrics (i->second));
+      }
+    std::map<std::string, FlowMonitor::FlowStats> perType = MergeByType (flowMonitor, flowHelper);
+    for (std::map<std::string, FlowMonitor::FlowStats>::const_iterator m = perType.begin (); m != perType.end (); ++m)
+      {
+        os << "Application " << m->first << " (all flows)\n";
+        PrintFlowMetrics (os, ComputeFlowMetrics (m->second));
+      }
+  }
+
+private:
+  const App *
+  FindApp (const FlowTuple &t) const
+  {
+    for (uint32_t a = 0; a < m_apps.size (); ++a)
+      {
+        if (t.sourcePort == m_apps[a].port || t.destinationPort == m_apps[a].port)
+          {
+            return &m_apps[a];
+          }
+      }
+    return 0;
+  }
+
+  //Browsing, with the object sizes of the HTTP scenarios
+  void
+  InstallHttp (Ptr<Node> ue, uint16_t port, Time start)
+  {
+    ThreeGppHttpServerHelper serverHelper (m_serverAddress);
+    serverHelper.SetAttribute ("LocalPort", UintegerValue (port));
+    ApplicationContainer serverApps = serverHelper.Install (m_server);
+    Ptr<ThreeGppHttpServer> httpServer = serverApps.Get (0)->GetObject<ThreeGppHttpServer> ();
+    PointerValue varPtr;
+    httpServer->GetAttribute ("Variables", varPtr);
+    Ptr<ThreeGppHttpVariables> httpVariables = varPtr.Get<ThreeGppHttpVariables> ();
+    httpVariables->SetMainObjectSizeMean (102400); // 100KB
+    httpVariables->SetMainObjectSizeStdDev (40960); // 40KB
+
+    ThreeGppHttpClientHelper clientHelper (m_serverAddress);
+    clientHelper.SetAttribute ("RemoteServerPort", UintegerValue (port));
+    ApplicationContainer clientApps = clientHelper.Install (ue);
+    clientApps.Start (start);
+  }
+
+  //Call with the packet interval of the VoIP scenarios
+  void
+  InstallVoip (Ptr<Node> ue, uint16_t port, Time start)
+  {
+    NS_ABORT_MSG_IF (m_useV6, "The VoIP traffic generator only supports IPv4");
+    VoipServerHelper voipServer (port);
+    voipServer.SetAttribute ("Interval", TimeValue (Seconds (0.05)));
+    ApplicationContainer apps = voipServer.Install (m_server);
+    VoipClientHelper voipClient (Ipv4Address::ConvertFrom (m_serverAddress), port);
+    apps = voipClient.Install (ue);
+    apps.Start (start);
+  }
+
+  //Unlimited upload at m_tcpRate, like a background sync
+  void
+  InstallTcp (Ptr<Node> ue, uint16_t port, Time start)
+  {
+    PacketSinkHelper sinkHelper ("ns3::TcpSocketFactory", AnySocketAddress (m_useV6, port));
+    ApplicationContainer sinkApp = sinkHelper.Install (m_server);
+    OnOffHelper client ("ns3::TcpSocketFactory", SocketAddress (m_serverAddress, port));
+    client.SetAttribute ("OnTime", StringValue ("ns3::ConstantRandomVariable[Constant=1]"));
+    client.SetAttribute ("OffTime", StringValue ("ns3::ConstantRandomVariable[Constant=0]"));
+    client.SetAttribute ("DataRate", DataRateValue (DataRate (m_tcpRate)));
+    client.SetAttribute ("PacketSize", UintegerValue (1024));
+    ApplicationContainer clientApp = client.Install (ue);
+    clientApp.Start (start);
+  }
+
+  //Stream with the packet size and interval of the UDP scenarios
+  void
+  InstallUdp (Ptr<Node> ue, uint16_t port, Time start)
+  {
+    UdpServerHelper server (port);
+    ApplicationContainer apps = server.Install (m_server);
+    UdpClientHelper client (m_serverAddress, port);
+    client.SetAttribute ("MaxPackets", UintegerValue (0));
+    client.SetAttribute ("Interval", TimeValue (Seconds (0.05)));
+    client.SetAttribute ("PacketSize", UintegerValue (1024));
+    apps = client.Install (ue);
+    apps.Start (start);
+  }
+
+  Ptr<Node> m_server;
+  Address m_serverAddress;
+  bool m_useV6;
+  uint16_t m_nextPort;
+  uint32_t m_numUes;
+  std::string m_tcpRate;
+  std::vector<App> m_apps;
+};
+
+} // namespace ns3
+
+#endif /* TRAFFIC_PROFILES_H */
@@ -0,0 +1,47 @@
+#!/bin/sh
+# Sweep the train scenario over handover algorithms, their parameters and
+# train speeds. Run from the 'ns3-mmwave' folder, like './waf --run'.
+# Every run appends one line (handovers, mean interruption, goodput) to
+# $SWEEP_FILE.
+#
+#   sh scratch/trainHandoverSweep.sh
+#   SIM_TIME=1200s SPEEDS="25 50" sh scratch/trainHandoverSweep.sh
+
+# Unless SIM_TIME is set every run lasts the journey along the default
+# 30 km track at its speed, plus the 2 s before the clients start
+SIM_TIME=${SIM_TIME:-}
+TRACK_M=30000
+SPEEDS=${SPEEDS:-"25 50 75 100"}
+SWEEP_FILE=${SWEEP_FILE:-HandoverSweepUDPTrainJourney.csv}
+
+# A2A4 (RSRQ): serving cell threshold x neighbour offset
+A2A4_THRESHOLDS=${A2A4_THRESHOLDS:-"20 30 34"}
+A2A4_OFFSETS=${A2A4_OFFSETS:-"1 3"}
+
+# A3 (RSRP): hysteresis [dB] x time to trigger [ms]
+A3_HYSTERESIS=${A3_HYSTERESIS:-"1 3 5"}
+A3_TTT=${A3_TTT:-"40 100 256"}
+
+run ()
+{
+  echo "UDPTrainJourney $*"
+  sim_time=${SIM_TIME:-$((TRACK_M / speed + 2))s}
+  ./waf --run "scratch/UDPTrainJourney --simTime=$sim_time --sweepFile=$SWEEP_FILE --animInterval=0 $*" > /dev/null || exit 1
+}
+
+for speed in $SPEEDS; do
+  for thr in $A2A4_THRESHOLDS; do
+    for off in $A2A4_OFFSETS; do
+      run --trainSpeed=$speed \
+          --handoverAlgorithm=A2A4 --servingCellThreshold=$thr --neighbourCellOffset=$off
+    done
+  done
+  for hys in $A3_HYSTERESIS; do
+    for ttt in $A3_TTT; do
+      run --trainSpeed=$speed \
+          --handoverAlgorithm=A3 --hysteresis=$hys --timeToTrigger=$ttt
+    done
+  done
+done
+
+echo "Results in $SWEEP_FILE"
@@ -0,0 +1,23 @@
+#!/bin/sh
+# Compare the LTE MAC schedulers on the train scenario for growing numbers
+# of UEs. Run from the 'ns3-mmwave' folder, like './waf --run'. Every run
+# appends one line (scheduled cell throughput, Jain's index, wall clock per
+# TTI) to $SWEEP_FILE.
+#
+#   sh scratch/trainSchedulerSweep.sh
+#   SCHEDULERS="pf rr" UES="10 50" sh scratch/trainSchedulerSweep.sh
+
+# Long enough for the whole journey: the default 30 km track at 25 m/s
+SIM_TIME=${SIM_TIME:-1200s}
+SCHEDULERS=${SCHEDULERS:-"pf rr tdmt tta pss cqa"}
+UES=${UES:-"5 10 20 40"}
+SWEEP_FILE=${SWEEP_FILE:-SchedulerSweepUDPTrainJourney.csv}
+
+for ues in $UES; do
+  for scheduler in $SCHEDULERS; do
+    echo "UDPTrainJourney --scheduler=$scheduler --numberOfUEs=$ues"
+    ./waf --run "scratch/UDPTrainJourney --simTime=$SIM_TIME --sweepFile=$SWEEP_FILE --animInterval=0 --scheduler=$scheduler --numberOfUEs=$ues" > /dev/null || exit 1
+  done
+done
+
+echo "Results in $SWEEP_FILE"
@@ -0,0 +1,728 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//RRC and DRX state aware UE radio energy model.
+//
+//Neither the LTE nor the mmWave module model RRC release or DRX, so the
+//radio state is derived from the UE's own IP traffic with the usual tail
+//timers: every packet puts the radio in ACTIVE, then it falls back to
+//continuous reception, short DRX, long DRX and finally RRC_IDLE when the
+//timers expire without traffic. Leaving RRC_IDLE costs a promotion.
+//DRX and paging cycles are accounted with their average current.
+//
+//The model is event driven: one event per state change, cancelled when a
+//new packet arrives, and energy is integrated only when the state changes.
+//The energy source is updated at the same points, so a LiIonEnergySource
+//does not need a short PeriodicEnergyUpdateInterval.
+//
+//The first packet that finds the radio asleep pays a wake-up latency,
+//which the stack does not add and the model only accounts: a downlink
+//packet waits for the next DRX on duration, or in RRC_IDLE for the next
+//paging occasion and the promotion, an uplink packet only for the
+//promotion. The energy is also compared with an always connected UE,
+//active for the same time and in continuous reception otherwise.
+//
+//A flow is charged the energy the UE spent from its first packet to its
+//last plus the tail up to RRC release, the time it kept the radio up.
+
+#ifndef UE_ENERGY_MODEL_H
+#define UE_ENERGY_MODEL_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/energy-module.h"
+#include "ns3/flow-monitor-helper.h"
+
+#include "flow-metrics.h"
+
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <vector>
+
+namespace ns3 {
+
+class UeRadioEnergyModel : public DeviceEnergyModel
+{
+public:
+  enum RadioState
+  {
+    PROMOTION = 0, //RRC_IDLE to RRC_CONNECTED
+    ACTIVE,        //transmitting or receiving
+    CONTINUOUS_RX, //connected, DRX inactivity timer running
+    SHORT_DRX,
+    LONG_DRX,
+    IDLE,          //RRC_IDLE with paging
+    NUM_STATES
+  };
+
+  static TypeId
+  GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("ns3::UeRadioEnergyModel")
+      .SetParent<DeviceEnergyModel> ()
+      .SetGroupName ("Energy")
+      .AddConstructor<UeRadioEnergyModel> ()
+      .AddAttribute ("SupplyVoltageV", "Voltage used when no energy source is attached",
+                     DoubleValue (3.7),
+                     MakeDoubleAccessor (&UeRadioEnergyModel::m_voltageV),
+                     MakeDoubleChecker<double> (0.0))
+      .AddAttribute ("PromotionCurrentA", "Current while promoting from RRC_IDLE",
+                     DoubleValue (0.327),
+                     MakeDoubleAccessor (&UeRadioEnergyModel::m_promotionCurrentA),
+                     MakeDoubleChecker<double> (0.0))
+      .AddAttribute ("ActiveCurrentA", "Current while transmitting or receiving",
+                     DoubleValue (0.348),
+                     MakeDoubleAccessor (&UeRadioEnergyModel::m_activeCurrentA),
+                     MakeDoubleChecker<double> (0.0))
+      .AddAttribute ("ContinuousRxCurrentA", "Current while monitoring the PDCCH without DRX",
+                     DoubleValue (0.286),
+                     MakeDoubleAccessor (&UeRadioEnergyModel::m_continuousRxCurrentA),
+                     MakeDoubleChecker<double> (0.0))
+      .AddAttribute ("DrxOnCurrentA", "Current during a DRX on duration",
+                     DoubleValue (0.454),
+                     MakeDoubleAccessor (&UeRadioEnergyModel::m_drxOnCurrentA),
+                     MakeDoubleChecker<double> (0.0))
+      .AddAttribute ("DrxSleepCurrentA", "Current between DRX on durations",
+                     DoubleValue (0.011),
+                     MakeDoubleAccessor (&UeRadioEnergyModel::m_drxSleepCurrentA),
+                     MakeDoubleChecker<double> (0.0))
+      .AddAttribute ("PagingCurrentA", "Current during an RRC_IDLE paging occasion",
+                     DoubleValue (0.161),
+                     MakeDoubleAccessor (&UeRadioEnergyModel::m_pagingCurrentA),
+                     MakeDoubleChecker<double> (0.0))
+      .AddAttribute ("IdleCurrentA", "Current between paging occasions",
+                     DoubleValue (0.003),
+                     MakeDoubleAccessor (&UeRadioEnergyModel::m_idleCurrentA),
+                     MakeDoubleChecker<double> (0.0))
+      .AddAttribute ("ActiveHoldTime", "Time the radio stays active after each packet",
+                     TimeValue (MilliSeconds (1)),
+                     MakeTimeAccessor (&UeRadioEnergyModel::m_activeHold),
+                     MakeTimeChecker ())
+      .AddAttribute ("PromotionTime", "RRC_IDLE to RRC_CONNECTED promotion delay",
+                     TimeValue (MilliSeconds (260)),
+                     MakeTimeAccessor (&UeRadioEnergyModel::m_promotionTime),
+                     MakeTimeChecker ())
+      .AddAttribute ("EnableDrx", "Use connected mode DRX, otherwise stay in continuous reception",
+                     BooleanValue (true),
+                     MakeBooleanAccessor (&UeRadioEnergyModel::m_drx),
+                     MakeBooleanChecker ())
+      .AddAttribute ("DrxInactivityTimer", "Continuous reception time after the last packet",
+                     TimeValue (MilliSeconds (100)),
+                     MakeTimeAccessor (&UeRadioEnergyModel::m_drxInactivity),
+                     MakeTimeChecker ())
+      .AddAttribute ("DrxOnDuration", "On duration of every DRX and paging cycle",
+                     TimeValue (MilliSeconds (1)),
+                     MakeTimeAccessor (&UeRadioEnergyModel::m_drxOnDuration),
+                     MakeTimeChecker ())
+      .AddAttribute ("ShortDrxCycle", "Short DRX cycle length",
+                     TimeValue (MilliSeconds (20)),
+                     MakeTimeAccessor (&UeRadioEnergyModel::m_shortDrxCycle),
+                     MakeTimeChecker ())
+      .AddAttribute ("ShortDrxCycles", "Number of short DRX cycles before long DRX",
+                     UintegerValue (20),
+                     MakeUintegerAccessor (&UeRadioEnergyModel::m_shortDrxCycles),
+                     MakeUintegerChecker<uint32_t> ())
+      .AddAttribute ("LongDrxCycle", "Long DRX cycle length",
+                     TimeValue (MilliSeconds (40)),
+                     MakeTimeAccessor (&UeRadioEnergyModel::m_longDrxCycle),
+                     MakeTimeChecker ())
+      .AddAttribute ("RrcInactivityTimer", "Time without traffic before RRC release",
+                     TimeValue (Seconds (11.5)),
+                     MakeTimeAccessor (&UeRadioEnergyModel::m_rrcInactivity),
+                     MakeTimeChecker ())
+      .AddAttribute ("PagingCycle", "RRC_IDLE paging cycle",
+                     TimeValue (MilliSeconds (1280)),
+                     MakeTimeAccessor (&UeRadioEnergyModel::m_pagingCycle),
+                     MakeTimeChecker ())
+      .AddAttribute ("PagingOnDuration", "Time awake per paging occasion",
+                     TimeValue (MilliSeconds (43)),
+                     MakeTimeAccessor (&UeRadioEnergyModel::m_pagingOnDuration),
+                     MakeTimeChecker ())
+    ;
+    return tid;
+  }
+
+  UeRadioEnergyModel ()
+    : m_state (IDLE),
+      m_totalEnergyJ (0.0),
+      m_promotions (0),
+      m_depleted (false)
+  {
+    for (uint32_t s = 0; s < NUM_STATES; ++s)
+      {
+        m_timeInState[s] = Seconds (0);
+      }
+    for (uint32_t d = 0; d < 2; ++d)
+      {
+        m_wakeups[d] = 0;
+        m_wakeupSum[d] = 0;
+        m_wakeupDelay[d].SetDefaultBinWidth (1e-3);
+      }
+  }
+
+  //Follow the IP traffic of the UE node. The UE starts in RRC_IDLE.
+  void
+  AttachTo (Ptr<Node> node)
+  {
+    m_node = node;
+    m_lastUpdate = Simulator::Now ();
+    m_attached = Simulator::Now ();
+    m_idleSince = Simulator::Now ();
+    EnergyMark mark = { Simulator::Now (), m_totalEnergyJ, m_state };
+    m_marks.push_back (mark);
+    Ptr<Ipv4L3Protocol> ipv4 = node->GetObject<Ipv4L3Protocol> ();
+    if (ipv4)
+      {
+        ipv4->TraceConnectWithoutContext ("Tx", MakeCallback (&UeRadioEnergyModel::TxV4, this));
+        ipv4->TraceConnectWithoutContext ("Rx", MakeCallback (&UeRadioEnergyModel::RxV4, this));
+      }
+    Ptr<Ipv6L3Protocol> ipv6 = node->GetObject<Ipv6L3Protocol> ();
+    if (ipv6)
+      {
+        ipv6->TraceConnectWithoutContext ("Tx", MakeCallback (&UeRadioEnergyModel::TxV6, this));
+        ipv6->TraceConnectWithoutContext ("Rx", MakeCallback (&UeRadioEnergyModel::RxV6, this));
+      }
+  }
+
+  Ptr<Node>
+  GetNode () const
+  {
+    return m_node;
+  }
+
+  //A packet was sent or received: wake up and restart the tail timers
+  void
+  NotifyActivity (bool downlink = false)
+  {
+    if (m_depleted)
+      {
+        return;
+      }
+    if (m_state == SHORT_DRX || m_state == LONG_DRX || m_state == IDLE)
+      {
+        //the first packet after a sleep
+        double delay = GetWakeupDelay (downlink).GetSeconds ();
+        m_wakeups[downlink]++;
+        m_wakeupSum[downlink] += delay;
+        m_wakeupDelay[downlink].AddValue (delay);
+      }
+    m_lastActivity = Simulator::Now ();
+    if (m_state == PROMOTION)
+      {
+        //the packet is served once the promotion completes
+        return;
+      }
+    if (m_state == IDLE)
+      {
+        m_promotions++;
+        SetState (PROMOTION);
+        m_timer.Cancel ();
+        m_timer = Simulator::Schedule (m_promotionTime, &UeRadioEnergyModel::PromotionDone, this);
+        return;
+      }
+    SetState (ACTIVE);
+    ScheduleNextState ();
+  }
+
+  RadioState
+  GetState () const
+  {
+    return m_state;
+  }
+
+  uint32_t
+  GetPromotions () const
+  {
+    return m_promotions;
+  }
+
+  //First packets that found the radio asleep, downlink or uplink
+  uint32_t
+  GetWakeups (bool downlink) const
+  {
+    return m_wakeups[downlink];
+  }
+
+  //Mean, or fraction q (0..1) percentile, wake-up latency of those [s]
+  double
+  GetWakeupLatency (bool downlink, double q = -1) const
+  {
+    if (q < 0)
+      {
+        return SafeRatio (m_wakeupSum[downlink], m_wakeups[downlink]);
+      }
+    return HistogramPercentile (m_wakeupDelay[downlink], q);
+  }
+
+  //Energy of a UE that never sleeps: active as long as this one and in
+  //continuous reception the rest of the time
+  double
+  GetAlwaysConnectedEnergy () const
+  {
+    double activeS = GetTimeInState (ACTIVE).GetSeconds ();
+    double totalS = (Simulator::Now () - m_attached).GetSeconds ();
+    return GetVoltage () * (m_activeCurrentA * activeS + m_continuousRxCurrentA * (totalS - activeS));
+  }
+
+  //Energy spent between two times since the UE was attached [J]
+  double
+  GetEnergyBetween (Time from, Time to) const
+  {
+    return to > from ? GetEnergyAt (to) - GetEnergyAt (from) : 0.0;
+  }
+
+  //Time the radio stays connected after the last packet
+  Time
+  GetTail () const
+  {
+    return m_rrcInactivity;
+  }
+
+  Time
+  GetTimeInState (RadioState state) const
+  {
+    Time t = m_timeInState[state];
+    if (state == m_state)
+      {
+        t += Simulator::Now () - m_lastUpdate;
+      }
+    return t;
+  }
+
+  static std::string
+  GetStateName (RadioState state)
+  {
+    static const char *names[NUM_STATES] = { "promotion", "active", "continuousRx", "shortDrx", "longDrx", "idle" };
+    return names[state];
+  }
+
+  //DeviceEnergyModel
+  virtual void
+  SetEnergySource (Ptr<EnergySource> source)
+  {
+    m_source = source;
+  }
+
+  virtual double
+  GetTotalEnergyConsumption (void) const
+  {
+    return m_totalEnergyJ + GetStateCurrentA (m_state) * GetVoltage () * (Simulator::Now () - m_lastUpdate).GetSeconds ();
+  }
+
+  virtual void
+  ChangeState (int newState)
+  {
+    SetState (static_cast<RadioState> (newState));
+  }
+
+  virtual void
+  HandleEnergyDepletion (void)
+  {
+    //the battery is empty: stop following traffic and stay idle
+    m_depleted = true;
+    m_timer.Cancel ();
+  }
+
+  virtual void
+  HandleEnergyRecharged (void)
+  {
+    m_depleted = false;
+  }
+
+  virtual void
+  HandleEnergyChanged (void)
+  {
+  }
+
+protected:
+  virtual void
+  DoDispose (void)
+  {
+    m_timer.Cancel ();
+    m_source = 0;
+    m_node = 0;
+    DeviceEnergyModel::DoDispose ();
+  }
+
+private:
+  virtual double
+  DoGetCurrentA (void) const
+  {
+    return GetStateCurrentA (m_state);
+  }
+
+  double
+  GetVoltage () const
+  {
+    return m_source ? m_source->GetSupplyVoltage () : m_voltageV;
+  }
+
+  //Time from now to the next on duration of cycles starting at start, 0
+  //during one
+  Time
+  UntilOnDuration (Time start, Time cycle, Time on) const
+  {
+    Time since = Simulator::Now () - start;
+    if (since.IsStrictlyNegative () || cycle <= on)
+      {
+        return Seconds (0);
+      }
+    Time phase = NanoSeconds (since.GetNanoSeconds () % cycle.GetNanoSeconds ());
+    return phase < on ? Seconds (0) : cycle - phase;
+  }
+
+  //Latency a packet arriving now adds to wake the radio, uplink packets
+  //send a scheduling request at once and only wait out RRC_IDLE
+  Time
+  GetWakeupDelay (bool downlink) const
+  {
+    Time drxStart = m_lastActivity + m_drxInactivity;
+    switch (m_state)
+      {
+      case SHORT_DRX:
+        return downlink ? UntilOnDuration (drxStart, m_shortDrxCycle, m_drxOnDuration) : Seconds (0);
+      case LONG_DRX:
+        return downlink ? UntilOnDuration (drxStart + m_shortDrxCycle * m_shortDrxCycles, m_longDrxCycle,
+                                           m_drxOnDuration)
+                        : Seconds (0);
+      case IDLE:
+        return (downlink ? UntilOnDuration (m_idleSince, m_pagingCycle, m_pagingOnDuration) : Seconds (0))
+               + m_promotionTime;
+      default:
+        return Seconds (0);
+      }
+  }
+
+  //Average current over one cycle of awake time on and sleep current off
+  static double
+  CycleCurrentA (Time on, Time cycle, double onA, double offA)
+  {
+    if (cycle <= on)
+      {
+        return onA;
+      }
+    double f = on.GetSeconds () / cycle.GetSeconds ();
+    return f * onA + (1.0 - f) * offA;
+  }
+
+  double
+  GetStateCurrentA (RadioState state) const
+  {
+    switch (state)
+      {
+      case PROMOTION:
+        return m_promotionCurrentA;
+      case ACTIVE:
+        return m_activeCurrentA;
+      case CONTINUOUS_RX:
+        return m_continuousRxCurrentA;
+      case SHORT_DRX:
+        return CycleCurrentA (m_drxOnDuration, m_shortDrxCycle, m_drxOnCurrentA, m_drxSleepCurrentA);
+      case LONG_DRX:
+        return CycleCurrentA (m_drxOnDuration, m_longDrxCycle, m_drxOnCurrentA, m_drxSleepCurrentA);
+      case IDLE:
+        return CycleCurrentA (m_pagingOnDuration, m_pagingCycle, m_pagingCurrentA, m_idleCurrentA);
+      default:
+        NS_FATAL_ERROR ("Unknown UE radio state " << state);
+      }
+    return 0.0;
+  }
+
+  //Account the time spent in the current state and switch
+  void
+  SetState (RadioState newState)
+  {
+    Time now = Simulator::Now ();
+    Time elapsed = now - m_lastUpdate;
+    m_totalEnergyJ += GetStateCurrentA (m_state) * GetVoltage () * elapsed.GetSeconds ();
+    m_timeInState[m_state] += elapsed;
+    m_lastUpdate = now;
+    if (m_source)
+      {
+        //charge the elapsed time to the source at the old current first
+        m_source->UpdateEnergySource ();
+      }
+    if (newState == IDLE && m_state != IDLE)
+      {
+        m_idleSince = now;
+      }
+    if (newState != m_state)
+      {
+        EnergyMark mark = { now, m_totalEnergyJ, newState };
+        m_marks.push_back (mark);
+      }
+    m_state = newState;
+  }
+
+  //Energy spent from the attach to t, linear within a state
+  double
+  GetEnergyAt (Time t) const
+  {
+    if (m_marks.empty () || t <= m_marks.front ().at)
+      {
+        return 0.0;
+      }
+    t = Min (t, Simulator::Now ());
+    uint32_t m = m_marks.size () - 1;
+    while (m > 0 && m_marks[m].at > t)
+      {
+        m--;
+      }
+    const EnergyMark &mark = m_marks[m];
+    return mark.energyJ + GetStateCurrentA (mark.state) * GetVoltage () * (t - mark.at).GetSeconds ();
+  }
+
+  void
+  PromotionDone ()
+  {
+    //the queued traffic goes out now
+    m_lastActivity = Simulator::Now ();
+    SetState (ACTIVE);
+    ScheduleNextState ();
+  }
+
+  //Schedule the expiry of the timer that ends the current state, all
+  //timers count from the last packet
+  void
+  ScheduleNextState ()
+  {
+    m_timer.Cancel ();
+    Time shortEnd = m_drxInactivity + m_shortDrxCycle * m_shortDrxCycles;
+    RadioState next = IDLE;
+    Time at = m_rrcInactivity;
+    switch (m_state)
+      {
+      case ACTIVE:
+        next = CONTINUOUS_RX;
+        at = m_activeHold;
+        break;
+      case CONTINUOUS_RX:
+        if (m_drx)
+          {
+            next = m_shortDrxCycles > 0 ? SHORT_DRX : LONG_DRX;
+            at = m_drxInactivity;
+          }
+        break;
+      case SHORT_DRX:
+        next = LONG_DRX;
+        at = shortEnd;
+        break;
+      case LONG_DRX:
+        break;
+      default:
+        return;
+      }
+    if (at >= m_rrcInactivity)
+      {
+        //RRC release comes first
+        next = IDLE;
+        at = m_rrcInactivity;
+      }
+    Time delay = m_lastActivity + at - Simulator::Now ();
+    if (delay.IsStrictlyNegative ())
+      {
+        delay = Seconds (0);
+      }
+    m_timer = Simulator::Schedule (delay, &UeRadioEnergyModel::TimerExpired, this, next);
+  }
+
+  void
+  TimerExpired (RadioState next)
+  {
+    SetState (next);
+    ScheduleNextState ();
+  }
+
+  void
+  TxV4 (Ptr<const Packet> p, Ptr<Ipv4> ipv4, uint32_t interface)
+  {
+    NotifyActivity (false);
+  }
+
+  void
+  RxV4 (Ptr<const Packet> p, Ptr<Ipv4> ipv4, uint32_t interface)
+  {
+    NotifyActivity (true);
+  }
+
+  void
+  TxV6 (Ptr<const Packet> p, Ptr<Ipv6> ipv6, uint32_t interface)
+  {
+    NotifyActivity (false);
+  }
+
+  void
+  RxV6 (Ptr<const Packet> p, Ptr<Ipv6> ipv6, uint32_t interface)
+  {
+    NotifyActivity (true);
+  }
+
+  //Energy and state from each state change on
+  struct EnergyMark
+  {
+    Time at;
+    double energyJ;
+    RadioState state;
+  };
+
+  Ptr<EnergySource> m_source;
+  Ptr<Node> m_node;
+  RadioState m_state;
+  Time m_lastUpdate;   //last time energy was integrated
+  Time m_lastActivity; //last packet, the tail timers count from here
+  Time m_attached;
+  Time m_idleSince;    //start of the paging cycles
+  Time m_timeInState[NUM_STATES];
+  double m_totalEnergyJ;
+  uint32_t m_promotions;
+  bool m_depleted;
+  EventId m_timer;
+  uint32_t m_wakeups[2]; //uplink, downlink
+  double m_wakeupSum[2];
+  Histogram m_wakeupDelay[2];
+  std::vector<EnergyMark> m_marks;
+
+  double m_voltageV;
+  double m_promotionCurrentA;
+  double m_activeCurrentA;
+  double m_continuousRxCurrentA;
+  double m_drxOnCurrentA;
+  double m_drxSleepCurrentA;
+  double m_pagingCurrentA;
+  double m_idleCurrentA;
+  Time m_activeHold;
+  Time m_promotionTime;
+  bool m_drx;
+  Time m_drxInactivity;
+  Time m_drxOnDuration;
+  Time m_shortDrxCycle;
+  uint32_t m_shortDrxCycles;
+  Time m_longDrxCycle;
+  Time m_rrcInactivity;
+  Time m_pagingCycle;
+  Time m_pagingOnDuration;
+};
+
+NS_OBJECT_ENSURE_REGISTERED (UeRadioEnergyModel);
+
+//DRX and RRC timers of the UE radio, the defaults are those of the model
+struct DrxConfig
+{
+  bool enableDrx;
+  double inactivityMs;   //continuous reception after the last packet
+  double onDurationMs;
+  double shortCycleMs;
+  uint32_t shortCycles;  //before long DRX
+  double longCycleMs;
+  double rrcInactivityS; //without traffic before RRC release
+  double pagingCycleMs;
+  double promotionMs;    //RRC_IDLE to RRC_CONNECTED
+};
+
+inline DrxConfig
+DefaultDrxConfig ()
+{
+  DrxConfig c = { true, 100.0, 1.0, 20.0, 20, 40.0, 11.5, 1280.0, 260.0 };
+  return c;
+}
+
+//Set the timers of the UE radio energy models installed from now on,
+//aborts on cycles shorter than their on duration
+inline void
+ConfigureDrx (const DrxConfig &c)
+{
+  NS_ABORT_MSG_IF (c.onDurationMs <= 0 || c.shortCycleMs < c.onDurationMs || c.longCycleMs < c.onDurationMs,
+                   "DRX cycles must be at least as long as the on duration");
+  NS_ABORT_MSG_IF (c.inactivityMs < 0 || c.rrcInactivityS <= 0 || c.pagingCycleMs <= 0 || c.promotionMs < 0,
+                   "DRX and RRC timers cannot be negative");
+  Config::SetDefault ("ns3::UeRadioEnergyModel::EnableDrx", BooleanValue (c.enableDrx));
+  Config::SetDefault ("ns3::UeRadioEnergyModel::DrxInactivityTimer", TimeValue (MicroSeconds (1e3 * c.inactivityMs)));
+  Config::SetDefault ("ns3::UeRadioEnergyModel::DrxOnDuration", TimeValue (MicroSeconds (1e3 * c.onDurationMs)));
+  Config::SetDefault ("ns3::UeRadioEnergyModel::ShortDrxCycle", TimeValue (MicroSeconds (1e3 * c.shortCycleMs)));
+  Config::SetDefault ("ns3::UeRadioEnergyModel::ShortDrxCycles", UintegerValue (c.shortCycles));
+  Config::SetDefault ("ns3::UeRadioEnergyModel::LongDrxCycle", TimeValue (MicroSeconds (1e3 * c.longCycleMs)));
+  Config::SetDefault ("ns3::UeRadioEnergyModel::RrcInactivityTimer", TimeValue (MicroSeconds (1e6 * c.rrcInactivityS)));
+  Config::SetDefault ("ns3::UeRadioEnergyModel::PagingCycle", TimeValue (MicroSeconds (1e3 * c.pagingCycleMs)));
+  Config::SetDefault ("ns3::UeRadioEnergyModel::PromotionTime", TimeValue (MicroSeconds (1e3 * c.promotionMs)));
+}
+
+//Attach a radio energy model for the UE node to its battery
+inline Ptr<UeRadioEnergyModel>
+InstallUeRadioEnergyModel (Ptr<Node> ueNode, Ptr<EnergySource> source)
+{
+  Ptr<UeRadioEnergyModel> model = CreateObject<UeRadioEnergyModel> ();
+  model->SetEnergySource (source);
+  source->AppendDeviceEnergyModel (model);
+  model->AttachTo (ueNode);
+  return model;
+}
+
+//Energy of the UE radio and joules per delivered bit of the UE and of
+//every flow to or from it. Flows that overlap are each charged the time
+//they share, so their energies can add up to more than the UE's.
+inline void
+PrintUeEnergy (Ptr<FlowMonitor> flowMonitor, FlowMonitorHelper &flowHelper,
+               Ptr<UeRadioEnergyModel> model, std::ostream &os = std::cout)
+{
+  double energyJ = model->GetTotalEnergyConsumption ();
+  os << "UE radio energy: " << energyJ << " J, " << model->GetPromotions () << " RRC promotions\n";
+  for (uint32_t s = 0; s < UeRadioEnergyModel::NUM_STATES; ++s)
+    {
+      UeRadioEnergyModel::RadioState state = static_cast<UeRadioEnergyModel::RadioState> (s);
+      os << "  " << UeRadioEnergyModel::GetStateName (state) << ": "
+         << model->GetTimeInState (state).GetSeconds () << " s\n";
+    }
+  double connectedJ = model->GetAlwaysConnectedEnergy ();
+  os << "Always connected radio energy: " << connectedJ << " J, DRX and RRC release save "
+     << 100 * SafeRatio (connectedJ - energyJ, connectedJ) << " %\n";
+  for (uint32_t d = 0; d < 2; ++d)
+    {
+      bool downlink = d == 0;
+      os << "  " << (downlink ? "DL" : "UL") << " first packets waking the radio: " << model->GetWakeups (downlink);
+      if (model->GetWakeups (downlink) > 0)
+        {
+          os << ", wake-up latency mean " << 1e3 * model->GetWakeupLatency (downlink) << " ms, p95 "
+             << 1e3 * model->GetWakeupLatency (downlink, 0.95) << " ms";
+        }
+      os << "\n";
+    }
+
+  FlowMonitor::FlowStatsContainer stats = flowMonitor->GetFlowStats ();
+  uint64_t ueBits = 0;
+  std::ostringstream flows;
+  for (std::map<FlowId, FlowMonitor::FlowStats>::const_iterator i = stats.begin (); i != stats.end (); ++i)
+    {
+      const FlowMonitor::FlowStats &st = i->second;
+      if (!FlowTouchesNode (FindFlowTuple (flowMonitor, flowHelper, i->first), model->GetNode ()))
+        {
+          continue;
+        }
+      double flowJ = model->GetEnergyBetween (st.timeFirstTxPacket,
+                                              std::max (st.timeLastTxPacket, st.timeLastRxPacket) + model->GetTail ());
+      ueBits += st.rxBytes * 8;
+      flows << "Flow " << i->first << " energy: " << flowJ << " J, "
+            << SafeRatio (flowJ, st.rxBytes * 8) * 1e9 << " nJ/bit\n";
+    }
+  os << "UE energy per delivered bit: " << SafeRatio (energyJ, ueBits) * 1e9 << " nJ/bit\n";
+  os << flows.str ();
+}
+
+} // namespace ns3
+
+#endif /* UE_ENERGY_MODEL_H */